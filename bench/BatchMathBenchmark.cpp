@@ -0,0 +1,189 @@
+#include "Utils/BatchMath.h"
+
+#include <chrono>
+#include <limits>
+#include <random>
+
+// Times every BatchMath kernel with every implementation the cpu supports and checks that their outputs match the
+// scalar ones bit for bit. Every run generates fresh inputs, so no run works on the results of an earlier one.
+// Usage: XRLibBatchMathBenchmark [entry count]
+
+using namespace XRLib;
+
+namespace {
+constexpr int runCount = 5;
+
+enum Kernel {
+    COMPOSE_TRS,
+    PROPAGATE_HIERARCHY,
+    INVERSE_TRANSPOSE,
+    TRANSFORM_AABBS,
+    KERNEL_COUNT,
+};
+constexpr std::array<const char*, KERNEL_COUNT> kernelNames{"compose trs", "propagate", "inverse transpose",
+                                                            "transform aabb"};
+
+struct Inputs {
+    std::vector<glm::vec3> translations;
+    std::vector<glm::quat> rotations;
+    std::vector<glm::vec3> scales;
+    std::vector<glm::mat4> locals;
+    std::vector<uint32_t> parents;
+    std::vector<glm::vec4> centers;
+    std::vector<glm::vec4> extents;
+};
+
+struct Outputs {
+    explicit Outputs(size_t count)
+        : composed(count), worlds(count), normals(count), outCenters(count), outExtents(count) {}
+
+    std::vector<glm::mat4> composed;
+    std::vector<glm::mat4> worlds;
+    std::vector<glm::mat3x4> normals;
+    std::vector<glm::vec4> outCenters;
+    std::vector<glm::vec4> outExtents;
+};
+
+Inputs MakeInputs(size_t count, uint32_t seed) {
+    std::mt19937 random{seed};
+    std::uniform_real_distribution<float> distribution{-1.0f, 1.0f};
+    auto randomVec3 = [&]() { return glm::vec3(distribution(random), distribution(random), distribution(random)); };
+
+    Inputs inputs;
+    inputs.translations.resize(count);
+    inputs.rotations.resize(count);
+    inputs.scales.resize(count);
+    inputs.locals.resize(count);
+    inputs.parents.resize(count);
+    inputs.centers.resize(count);
+    inputs.extents.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        inputs.translations[i] = randomVec3() * 10.0f;
+        inputs.rotations[i] = glm::normalize(glm::quat(distribution(random), randomVec3()));
+        inputs.scales[i] = glm::abs(randomVec3()) + 0.5f;
+        inputs.centers[i] = glm::vec4(randomVec3(), 1.0f);
+        inputs.extents[i] = glm::vec4(glm::abs(randomVec3()), 0.0f);
+        // shallow random hierarchy, every parent precedes its children
+        inputs.parents[i] = i == 0 || i % 64 == 0 ? BatchMath::rootParent : static_cast<uint32_t>(random() % i);
+    }
+    // the locals come from the scalar kernel, so every implementation propagates the same matrices
+    const auto implementation = BatchMath::ActiveImplementation();
+    BatchMath::SetImplementation(BatchMath::Implementation::SCALAR);
+    BatchMath::ComposeTRS(inputs.translations.data(), inputs.rotations.data(), inputs.scales.data(),
+                          inputs.locals.data(), count);
+    BatchMath::SetImplementation(implementation);
+    return inputs;
+}
+
+template <typename T>
+bool SameBits(const std::vector<T>& lhs, const std::vector<T>& rhs) {
+    return lhs.size() == rhs.size() && std::memcmp(lhs.data(), rhs.data(), lhs.size() * sizeof(T)) == 0;
+}
+
+// the first mismatching kernel, KERNEL_COUNT if every output agrees
+Kernel FirstMismatch(const Outputs& outputs, const Outputs& reference) {
+    if (!SameBits(outputs.composed, reference.composed)) {
+        return COMPOSE_TRS;
+    }
+    if (!SameBits(outputs.worlds, reference.worlds)) {
+        return PROPAGATE_HIERARCHY;
+    }
+    if (!SameBits(outputs.normals, reference.normals)) {
+        return INVERSE_TRANSPOSE;
+    }
+    if (!SameBits(outputs.outCenters, reference.outCenters) || !SameBits(outputs.outExtents, reference.outExtents)) {
+        return TRANSFORM_AABBS;
+    }
+    return KERNEL_COUNT;
+}
+
+const char* ImplementationName(BatchMath::Implementation implementation) {
+    switch (implementation) {
+        case BatchMath::Implementation::AVX2:
+            return "AVX2";
+        case BatchMath::Implementation::SSE:
+            return "SSE";
+        default:
+            return "scalar";
+    }
+}
+
+// nanoseconds per entry of a single call
+template <typename Function>
+double Time(size_t count, Function&& function) {
+    const auto start = std::chrono::steady_clock::now();
+    function();
+    const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / std::max<size_t>(count, 1);
+}
+}    // namespace
+
+int main(int argc, char** argv) {
+    const size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100000;
+
+    std::cout << "Batch math benchmark over " << count << " entries, dispatching to "
+              << ImplementationName(BatchMath::ActiveImplementation()) << "\n";
+
+    // scalar first, it is the reference the others are compared against
+    std::vector<BatchMath::Implementation> implementations;
+    for (auto implementation : {BatchMath::Implementation::SCALAR, BatchMath::Implementation::SSE,
+                                BatchMath::Implementation::AVX2}) {
+        if (BatchMath::IsSupported(implementation)) {
+            implementations.push_back(implementation);
+        }
+    }
+
+    // best of all runs per implementation and kernel
+    std::vector<std::array<double, KERNEL_COUNT>> best(implementations.size());
+    for (auto& times : best) {
+        times.fill(std::numeric_limits<double>::max());
+    }
+
+    bool agree = true;
+    for (int run = 0; run < runCount; ++run) {
+        const Inputs inputs = MakeInputs(count, static_cast<uint32_t>(run));
+        Outputs reference{0};
+        for (size_t i = 0; i < implementations.size(); ++i) {
+            BatchMath::SetImplementation(implementations[i]);
+            Outputs outputs{count};
+            std::array<double, KERNEL_COUNT> times;
+            times[COMPOSE_TRS] = Time(count, [&]() {
+                BatchMath::ComposeTRS(inputs.translations.data(), inputs.rotations.data(), inputs.scales.data(),
+                                      outputs.composed.data(), count);
+            });
+            times[PROPAGATE_HIERARCHY] = Time(count, [&]() {
+                BatchMath::PropagateHierarchy(inputs.locals.data(), inputs.parents.data(), outputs.worlds.data(), 0,
+                                              count);
+            });
+            times[INVERSE_TRANSPOSE] = Time(
+                count, [&]() { BatchMath::InverseTranspose(outputs.worlds.data(), outputs.normals.data(), count); });
+            times[TRANSFORM_AABBS] = Time(count, [&]() {
+                BatchMath::TransformAABBs(outputs.worlds.data(), inputs.centers.data(), inputs.extents.data(),
+                                          outputs.outCenters.data(), outputs.outExtents.data(), count);
+            });
+            for (int kernel = 0; kernel < KERNEL_COUNT; ++kernel) {
+                best[i][kernel] = std::min(best[i][kernel], times[kernel]);
+            }
+
+            if (i == 0) {
+                reference = std::move(outputs);
+                continue;
+            }
+            const Kernel mismatch = FirstMismatch(outputs, reference);
+            if (mismatch != KERNEL_COUNT) {
+                std::cerr << ImplementationName(implementations[i]) << " " << kernelNames[mismatch]
+                          << " differs from scalar in run " << run << "\n";
+                agree = false;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < implementations.size(); ++i) {
+        std::cout << ImplementationName(implementations[i]) << " ns per entry:";
+        for (int kernel = 0; kernel < KERNEL_COUNT; ++kernel) {
+            std::cout << (kernel == 0 ? " " : ", ") << kernelNames[kernel] << " " << best[i][kernel];
+        }
+        std::cout << "\n";
+    }
+    return agree ? 0 : 1;
+}
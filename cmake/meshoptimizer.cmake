@@ -0,0 +1,12 @@
+set(MESHOPTIMIZER_DEPS meshoptimizer::meshoptimizer)
+find_package(meshoptimizer CONFIG QUIET)
+if (NOT meshoptimizer_FOUND)
+    message("${MESSAGE_BOX}\nmeshoptimizer not found, try fetching...\n${MESSAGE_BOX}")
+    FetchContent_Declare(
+        meshoptimizer
+        GIT_REPOSITORY https://github.com/zeux/meshoptimizer.git
+        GIT_TAG v0.22
+    )
+    FetchContent_MakeAvailable(meshoptimizer)
+    set(MESHOPTIMIZER_DEPS meshoptimizer)
+endif()
@@ -2,11 +2,13 @@ find_package(unofficial-shaderc CONFIG QUIET)
 
 if (unofficial-shaderc_FOUND)
     set(SHADERC_DEPS unofficial::shaderc::shaderc)
+    set(SHADERC_VERSION_STRING "${unofficial-shaderc_VERSION}")
 elseif(NOT TARGET shaderc::shaderc)
     find_package(shaderc CONFIG QUIET)
 
     if (shaderc_FOUND)
         set(SHADERC_DEPS shaderc::shaderc)
+        set(SHADERC_VERSION_STRING "${shaderc_VERSION}")
     else()
         message(WARNING "${MESSAGE_BOX}\nShaderc not found. Fetching dependencies...\n${MESSAGE_BOX}")
 
@@ -62,5 +64,12 @@ elseif(NOT TARGET shaderc::shaderc)
         FetchContent_MakeAvailable(SPIRV-Cross SPIRV-Headers SPIRV-Tools glslang shaderc)
 
         set(SHADERC_DEPS shaderc)
+        set(SHADERC_VERSION_STRING "v2024.0-glslang-d73712b8f6c9047b09e99614e20d456d5ada2390")
     endif()
 endif()
+
+# part of the shader cache key, spirv output changes between compiler releases
+if (NOT SHADERC_VERSION_STRING)
+    set(SHADERC_VERSION_STRING "unknown")
+endif()
+target_compile_definitions(${PROJECT_NAME} PRIVATE XRLIB_SHADERC_VERSION="${SHADERC_VERSION_STRING}")
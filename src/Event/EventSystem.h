@@ -2,8 +2,12 @@
 
 #include <pch.h>
 
+#include "Utils/FrameArena.h"
+
 /// <summary>
-/// A simple event system using string as key
+/// A simple event system using string as key.
+/// Events may be registered and triggered from the simulation and the render thread, the listener lists are
+/// guarded and listeners run on the triggering thread without the lock held
 /// </summary>
 namespace XRLib {
 class EventSystem {
@@ -16,13 +20,22 @@ class EventSystem {
     template <typename... Args>
     static void RegisterListener(const EventID& event,
                                  Callback<Args...> listener) {
+        std::lock_guard<std::mutex> lock(mutex());
         auto& listeners = getListeners<Args...>(event);
         listeners.push_back(listener);
     }
 
     template <typename... Args>
     static void TriggerEvent(const EventID& event, Args... args) {
-        auto& listeners = getListeners<Args...>(event);
+        // copied, so listeners can register new listeners and other threads can trigger meanwhile. The copy lives
+        // in the thread's frame arena and is released when the scope ends
+        FrameArena::Scope scope;
+        std::pmr::vector<Callback<Args...>> listeners{&FrameArena::ThreadLocal()};
+        {
+            std::lock_guard<std::mutex> lock(mutex());
+            const auto& registered = getListeners<Args...>(event);
+            listeners.assign(registered.begin(), registered.end());
+        }
         for (auto& listener : listeners) {
             listener(args...);
         }
@@ -30,12 +43,21 @@ class EventSystem {
 
     template <typename... Args>
     static void ClearEvent(const EventID& event) {
+        std::lock_guard<std::mutex> lock(mutex());
         listeners<Args...>().erase(event);
     }
 
-    static void ClearAll() { listenersMap().clear(); }
+    static void ClearAll() {
+        std::lock_guard<std::mutex> lock(mutex());
+        listenersMap().clear();
+    }
 
    private:
+    static std::mutex& mutex() {
+        static std::mutex eventMutex;
+        return eventMutex;
+    }
+
     struct IListenersBase {
         virtual ~IListenersBase() = default;
     };
@@ -11,6 +11,8 @@ class Events {
     inline static std::string XRLIB_EVENT_APPLICATION_INIT_FINISHED{"application_prepare_finished"};
     inline static std::string XRLIB_EVENT_APPLICATION_PRE_RENDERING{"application_pre_rendering"};
     inline static std::string XRLIB_EVENT_RENDERER_PRE_SUBMITTING{"renderer_pre_submitting"};
+    // right before the frame's command buffer goes to the queue, listeners can refresh poses one last time
+    inline static std::string XRLIB_EVENT_RENDERER_PRE_QUEUE_SUBMIT{"renderer_pre_queue_submit"};
     inline static std::string XRLIB_EVENT_APPLICATION_POST_RENDERING{"application_post_rendering"};
 
     // Scene events
@@ -15,6 +15,78 @@ class Primitives {
         }
     };
 
+    // 16 byte vertex: unorm16 position inside the mesh bounds, octahedral snorm16 normal, half float uv.
+    // The vertex shader decodes the position with the per mesh bounds.
+    struct QuantizedVertex {
+        uint16_t position[4];
+        int16_t normal[2];
+        uint16_t texCoords[2];
+
+        static QuantizedVertex FromVertex(const Vertex& vertex, const glm::vec3& boundsMin,
+                                          const glm::vec3& boundsExtent) {
+            QuantizedVertex quantized{};
+            glm::vec3 position = (vertex.position - boundsMin) / glm::max(boundsExtent, glm::vec3(1e-6f));
+            for (int i = 0; i < 3; ++i) {
+                quantized.position[i] = static_cast<uint16_t>(meshopt_quantizeUnorm(position[i], 16));
+            }
+
+            glm::vec2 octahedral = EncodeOctahedral(vertex.normal);
+            for (int i = 0; i < 2; ++i) {
+                quantized.normal[i] = static_cast<int16_t>(meshopt_quantizeSnorm(octahedral[i], 16));
+                quantized.texCoords[i] = meshopt_quantizeHalf(vertex.texCoords[i]);
+            }
+            return quantized;
+        }
+
+        static glm::vec2 EncodeOctahedral(glm::vec3 normal) {
+            float sum = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+            if (sum == 0.0f) {
+                return {0.0f, 0.0f};
+            }
+            normal /= sum;
+            if (normal.z >= 0.0f) {
+                return {normal.x, normal.y};
+            }
+            return {(1.0f - std::abs(normal.y)) * (normal.x >= 0.0f ? 1.0f : -1.0f),
+                    (1.0f - std::abs(normal.x)) * (normal.y >= 0.0f ? 1.0f : -1.0f)};
+        }
+    };
+
+    // vertex format uploaded to the gpu, selected at build time with XRLIB_QUANTIZED_VERTICES
+#ifdef XRLIB_QUANTIZED_VERTICES
+    using RenderVertex = QuantizedVertex;
+#else
+    using RenderVertex = Vertex;
+#endif
+
+    // per mesh quantization bounds, indexed by mesh index in the vertex shader
+    struct MeshBounds {
+        glm::vec4 min;
+        glm::vec4 extent;
+    };
+
+    // one entry of the material table, matches the Material struct of the default fragment shaders
+    struct MaterialData {
+        glm::uvec4 textures{0};    // texture heap slots: diffuse, normal, metallic roughness, emissive
+        glm::vec4 baseColorFactor{1.0f};
+        glm::vec4 emissiveFactorAlphaCutoff{1.0f, 1.0f, 1.0f, 0.5f};
+        glm::vec4 metallicRoughnessFactor{1.0f, 1.0f, 0.0f, 0.0f};
+    };
+
+    // push constants of every draw in the default pass
+    struct DrawPushConstants {
+        uint32_t modelIndex;
+        uint32_t materialIndex;
+    };
+
+    // 32 byte gpu light, layout shared with the Light struct of the default shaders
+    struct PointLightData {
+        glm::vec4 positionRange;
+        glm::vec4 colorIntensity;
+
+        bool operator==(const PointLightData& other) const = default;
+    };
+
     struct ViewProjection {
         alignas(16) glm::mat4 view;
         alignas(16) glm::mat4 proj;
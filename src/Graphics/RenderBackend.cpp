@@ -36,6 +36,8 @@ void RenderBackend::Prepare() {
         GetSwapchainConfig();
     }
 
+    renderBehavior->SetPipelined(info.pipelinedFrames && xrCore.IsXRValid());
+
     // vulkan prepare
     VkStandardRB* vkSRB = dynamic_cast<VkStandardRB*>(renderBehavior.get());
     vkSRB->InitVerticesIndicesBuffers();
@@ -65,5 +67,13 @@ void RenderBackend::RecordFrame(uint32_t& imageIndex) {
 void RenderBackend::EndFrame(uint32_t& imageIndex) {
     renderBehavior->EndFrame(imageIndex);
 }
+
+void RenderBackend::ExtractSnapshot() {
+    renderBehavior->ExtractSnapshot();
+}
+
+void RenderBackend::SwapSnapshots() {
+    renderBehavior->SwapSnapshots();
+}
 }    // namespace Graphics
 }    // namespace XRLib
@@ -20,6 +20,8 @@ class RenderBackend {
     void RecordFrame(uint32_t& imageIndex);
     void RecordFrame(uint32_t& imageIndex, std::function<void(uint32_t&, CommandBuffer&)> recordingFunction);
     void EndFrame(uint32_t& imageIndex);
+    void ExtractSnapshot();
+    void SwapSnapshots();
 
     void SetRenderBehavior(std::unique_ptr<StandardRB>& newRenderBahavior) {
         this->renderBehavior = std::move(newRenderBahavior);
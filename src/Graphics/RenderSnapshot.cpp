@@ -0,0 +1,80 @@
+#include "RenderSnapshot.h"
+
+namespace XRLib {
+namespace Graphics {
+void RenderSnapshot::Extract(Scene& scene) {
+    sceneGeneration = scene.Generation();
+    instanceGroupCount = scene.InstanceGroups().size();
+    scene.UpdateTransforms();
+
+    const size_t meshCount = scene.Meshes().size();
+    meshWorldMatrices.resize(meshCount);
+    meshMaterials.resize(meshCount);
+    meshVisible.resize(meshCount);
+    const bool rebuildMeshIndices = meshIndices.size() != meshCount || meshIndicesGeneration != sceneGeneration;
+    if (rebuildMeshIndices) {
+        meshIndices.clear();
+        meshIndicesGeneration = sceneGeneration;
+    }
+    for (size_t i = 0; i < meshCount; ++i) {
+        Mesh& mesh = *scene.Meshes()[i];
+        meshWorldMatrices[i] = mesh.GetWorldMatrix();
+        meshMaterials[i] = mesh.GetMaterialPtr().get();
+        meshVisible[i] = mesh.IsVisible();
+        if (rebuildMeshIndices) {
+            meshIndices.emplace(&mesh, static_cast<uint32_t>(i));
+        }
+    }
+
+    size_t firstInstance = 0;
+    for (const auto& instanceGroup : scene.InstanceGroups()) {
+        if (instanceGroup->IsDirty()) {
+            auto [begin, end] = instanceGroup->DirtyRange();
+            instanceRanges.push_back({firstInstance + begin, end - begin});
+            instanceTransforms.insert(instanceTransforms.end(), instanceGroup->GetTransforms().begin() + begin,
+                                      instanceGroup->GetTransforms().begin() + end);
+            instanceGroup->ClearDirty();
+        }
+        firstInstance += instanceGroup->Size();
+    }
+
+    const size_t lightCount = scene.PointLights().size();
+    lightPositionRanges.resize(lightCount);
+    lightColorIntensities.resize(lightCount);
+    for (size_t i = 0; i < lightCount; ++i) {
+        PointLight& light = *scene.PointLights()[i];
+        lightPositionRanges[i] = glm::vec4(glm::vec3(light.GetWorldMatrix()[3]), light.GetRange());
+        lightColorIntensities[i] = glm::vec4(glm::vec3(light.GetColor()), light.GetIntensity());
+    }
+
+    if (auto camera = scene.MainCamera()) {
+        cameraView = camera->CameraView();
+        cameraProjection = camera->CameraProjection();
+    }
+}
+
+void RenderSnapshot::ExtractSubtrees(std::span<Entity* const> roots, std::vector<uint32_t>& changedMeshes) {
+    for (Entity* root : roots) {
+        ExtractSubtree(root, root->GetGlobalTransform().GetMatrix(), changedMeshes);
+    }
+}
+
+void RenderSnapshot::ExtractSubtree(Entity* entity, const glm::mat4& world, std::vector<uint32_t>& changedMeshes) {
+    if (auto mesh = dynamic_cast<Mesh*>(entity)) {
+        auto it = meshIndices.find(mesh);
+        if (it != meshIndices.end() && meshWorldMatrices[it->second] != world) {
+            meshWorldMatrices[it->second] = world;
+            changedMeshes.push_back(it->second);
+        }
+    }
+    for (auto& child : entity->GetChilds()) {
+        ExtractSubtree(child.get(), world * child->GetLocalTransform().GetMatrix(), changedMeshes);
+    }
+}
+
+void RenderSnapshot::ConsumeInstanceUpdates() {
+    instanceTransforms.clear();
+    instanceRanges.clear();
+}
+}    // namespace Graphics
+}    // namespace XRLib
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "Scene/Scene.h"
+
+namespace XRLib {
+namespace Graphics {
+// Render relevant scene state of one frame, copied into flat arrays. It is extracted on the simulation thread and
+// the renderer reads only the snapshot while recording, never the entities, so recording can run on another thread
+// and walks contiguous memory instead of the hierarchy.
+class RenderSnapshot {
+   public:
+    // copies transforms, materials, visibility, lights and the camera. Changed instances are appended and kept
+    // until ConsumeInstanceUpdates, so updates of a frame that was never rendered are not lost
+    void Extract(Scene& scene);
+    void ConsumeInstanceUpdates();
+    // re-reads only the mesh matrices below the given entities, computed from their current local transforms
+    // without propagating the store. For late latching the controllers of a frame extracted before, the indices of
+    // the meshes that moved are appended to changedMeshes
+    void ExtractSubtrees(std::span<Entity* const> roots, std::vector<uint32_t>& changedMeshes);
+
+    size_t MeshCount() const { return meshWorldMatrices.size(); }
+    size_t PointLightCount() const { return lightPositionRanges.size(); }
+
+   public:
+    uint64_t sceneGeneration{0};
+    size_t instanceGroupCount{0};
+
+    // per mesh, indexed like Scene::Meshes
+    std::vector<glm::mat4> meshWorldMatrices;
+    std::vector<const Material*> meshMaterials;    // identity only, renderers map it to their material table
+    std::vector<uint8_t> meshVisible;
+
+    // changed instances of all groups back to back, ranges are (first instance, count) counted over all groups
+    std::vector<glm::mat4> instanceTransforms;
+    std::vector<std::pair<size_t, size_t>> instanceRanges;
+
+    // per point light, indexed like Scene::PointLights
+    std::vector<glm::vec4> lightPositionRanges;
+    std::vector<glm::vec4> lightColorIntensities;
+
+    // main camera, used by flat rendering
+    glm::mat4 cameraView{1.0f};
+    glm::mat4 cameraProjection{1.0f};
+
+   private:
+    void ExtractSubtree(Entity* entity, const glm::mat4& world, std::vector<uint32_t>& changedMeshes);
+
+   private:
+    // position of every mesh in the per mesh arrays, rebuilt by Extract when the mesh list changed
+    std::unordered_map<const Mesh*, uint32_t> meshIndices;
+    uint64_t meshIndicesGeneration{0};
+};
+}    // namespace Graphics
+}    // namespace XRLib
@@ -22,8 +22,18 @@ class StandardRB {
         this->renderPasses = &renderPasses;
     }
 
+    // frames are recorded on a render thread while the next one is simulated, the scene must not be read while
+    // recording then
+    void SetPipelined(bool enable) { pipelined = enable; }
+    // called on the simulation thread once the frame's scene updates are done, copies what rendering needs
+    virtual void ExtractSnapshot() {}
+    // called once the simulation of a frame is done and the render thread is idle, before the frame is recorded.
+    // Behaviours double buffering scene data swap their buffers here
+    virtual void SwapSnapshots() {}
+
    protected:
     bool stereo;
+    bool pipelined{false};
     Scene& scene;
     std::vector<std::unique_ptr<IGraphicsRenderpass>>* renderPasses;
 };
@@ -3,11 +3,12 @@
 namespace XRLib {
 namespace Graphics {
 
-CommandBuffer::CommandBuffer(VkCore& core) : core{core} {
+CommandBuffer::CommandBuffer(VkCore& core, VkCommandBufferLevel level, VkCommandPool commandPool)
+    : core{core}, commandPool{commandPool == VK_NULL_HANDLE ? core.GetCommandPool() : commandPool} {
     VkCommandBufferAllocateInfo allocInfo{};
     allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    allocInfo.commandPool = core.GetCommandPool();
-    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandPool = this->commandPool;
+    allocInfo.level = level;
     allocInfo.commandBufferCount = 1;
 
     if (vkAllocateCommandBuffers(core.GetRenderDevice(), &allocInfo, &commandBuffer) != VK_SUCCESS) {
@@ -16,7 +17,7 @@ CommandBuffer::CommandBuffer(VkCore& core) : core{core} {
 }
 
 CommandBuffer::~CommandBuffer() {
-    vkFreeCommandBuffers(core.GetRenderDevice(), core.GetCommandPool(), 1, &commandBuffer);
+    vkFreeCommandBuffers(core.GetRenderDevice(), commandPool, 1, &commandBuffer);
 }
 
 CommandBuffer CommandBuffer::BeginSingleTimeCommands(VkCore& core) {
@@ -35,12 +36,34 @@ void CommandBuffer::EndSingleTimeCommands(CommandBuffer& commandBuffer) {
 
 CommandBuffer& CommandBuffer::BindVertexBuffer(int firstBinding, std::vector<VkBuffer> buffers,
                                                std::vector<VkDeviceSize> offsets) {
+    if (buffers == bindState.vertexBuffers && offsets == bindState.vertexOffsets) {
+        return *this;
+    }
     vkCmdBindVertexBuffers(commandBuffer, 0, buffers.size(), buffers.data(), offsets.data());
+    bindState.vertexBuffers = std::move(buffers);
+    bindState.vertexOffsets = std::move(offsets);
+    return *this;
+}
+
+CommandBuffer& CommandBuffer::BindVertexBuffer(VkBuffer buffer, VkDeviceSize offset) {
+    if (bindState.vertexBuffers.size() == 1 && bindState.vertexBuffers[0] == buffer &&
+        bindState.vertexOffsets[0] == offset) {
+        return *this;
+    }
+    vkCmdBindVertexBuffers(commandBuffer, 0, 1, &buffer, &offset);
+    bindState.vertexBuffers.assign(1, buffer);
+    bindState.vertexOffsets.assign(1, offset);
     return *this;
 }
 
 CommandBuffer& CommandBuffer::BindIndexBuffer(VkBuffer indexBuffer, VkDeviceSize offset, VkIndexType indexType) {
+    if (indexBuffer == bindState.indexBuffer && offset == bindState.indexOffset && indexType == bindState.indexType) {
+        return *this;
+    }
     vkCmdBindIndexBuffer(commandBuffer, indexBuffer, offset, indexType);
+    bindState.indexBuffer = indexBuffer;
+    bindState.indexOffset = offset;
+    bindState.indexType = indexType;
     return *this;
 }
 
@@ -59,9 +82,17 @@ CommandBuffer& CommandBuffer::BindDescriptorSets(VkGraphicsRenderpass& pass, uin
         }
     }
     VkPipelineLayout layout = pass.GetPipeline().GetVkPipelineLayout();
+    // dynamic offsets can differ with the same sets, so those binds are never skipped
+    if (dynamicOffsetCount == 0 && layout == bindState.descriptorLayout && firstSet == bindState.firstSet &&
+        descriptorSets == bindState.descriptorSets) {
+        return *this;
+    }
     VkPipelineBindPoint bindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
     vkCmdBindDescriptorSets(commandBuffer, bindPoint, layout, firstSet, descriptorSets.size(), descriptorSets.data(),
                             dynamicOffsetCount, pDynamicOffsets);
+    bindState.descriptorLayout = dynamicOffsetCount == 0 ? layout : VK_NULL_HANDLE;
+    bindState.firstSet = firstSet;
+    bindState.descriptorSets = std::move(descriptorSets);
     return *this;
 }
 
@@ -74,10 +105,11 @@ CommandBuffer& CommandBuffer::StartRecord() {
     if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
         Util::ErrorPopup("Failed to begin recording command buffer");
     }
+    ResetBindState();
     return *this;
 }
 
-CommandBuffer& CommandBuffer::StartPass(VkGraphicsRenderpass& pass, uint32_t imageIndex) {
+CommandBuffer& CommandBuffer::StartPass(VkGraphicsRenderpass& pass, uint32_t imageIndex, VkSubpassContents contents) {
     if (pass.GetPipeline().GetVkPipeline() == VK_NULL_HANDLE) {
         Util::ErrorPopup("Graphics pipeline not initialized");
     }
@@ -103,29 +135,90 @@ CommandBuffer& CommandBuffer::StartPass(VkGraphicsRenderpass& pass, uint32_t ima
     renderPassInfo.clearValueCount = clearValues.size();
     renderPassInfo.pClearValues = clearValues.data();
 
-    vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
-    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pass.GetPipeline().GetVkPipeline());
+    vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, contents);
+    // passes may use different pipeline layouts, start every pass from a clean slate
+    ResetBindState();
+    currentPass = &pass;
+    if (contents == VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS) {
+        // state is set by every secondary command buffer on its own
+        return *this;
+    }
 
+    BindPipeline(VK_PIPELINE_BIND_POINT_GRAPHICS, pass.GetPipeline().GetVkPipeline());
+    SetViewportAndScissor(renderPassInfo.renderArea.extent);
+    return *this;
+}
+
+CommandBuffer& CommandBuffer::StartSecondaryRecord(VkGraphicsRenderpass& pass, uint32_t imageIndex) {
+    VkCommandBufferInheritanceInfo inheritanceInfo{};
+    inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+    inheritanceInfo.renderPass = pass.GetRenderpass().GetVkRenderpass();
+    inheritanceInfo.subpass = 0;
+    inheritanceInfo.framebuffer = pass.GetRenderpass().GetFrameBuffers()[imageIndex];
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    // not one time submit, cached frames execute the same secondary command buffers again
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+    beginInfo.pInheritanceInfo = &inheritanceInfo;
+
+    if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
+        Util::ErrorPopup("Failed to begin recording secondary command buffer");
+    }
+    ResetBindState();
+
+    // pipeline and dynamic state are not inherited from the primary command buffer
+    auto renderTarget = pass.GetRenderpass().GetRenderTargets()[imageIndex][0];
+    BindPipeline(VK_PIPELINE_BIND_POINT_GRAPHICS, pass.GetPipeline().GetVkPipeline());
+    SetViewportAndScissor(
+        {static_cast<uint32_t>(renderTarget->Width()), static_cast<uint32_t>(renderTarget->Height())});
+    return *this;
+}
+
+void CommandBuffer::EndSecondaryRecord() {
+    if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+        Util::ErrorPopup("Failed to record secondary command buffer");
+    }
+}
+
+CommandBuffer& CommandBuffer::ExecuteCommands(const std::vector<VkCommandBuffer>& secondaryCommandBuffers) {
+    if (!secondaryCommandBuffers.empty()) {
+        vkCmdExecuteCommands(commandBuffer, secondaryCommandBuffers.size(), secondaryCommandBuffers.data());
+    }
+    return *this;
+}
+
+void CommandBuffer::SetViewportAndScissor(VkExtent2D extent) {
     VkViewport viewport{};
     viewport.x = 0.0f;
     viewport.y = 0.0f;
-    viewport.width = renderPassInfo.renderArea.extent.width;
-    viewport.height = renderPassInfo.renderArea.extent.height;
+    viewport.width = extent.width;
+    viewport.height = extent.height;
     viewport.minDepth = 0.0f;
     viewport.maxDepth = 1.0f;
     vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
 
     VkRect2D scissor{};
     scissor.offset = {0, 0};
-    scissor.extent = renderPassInfo.renderArea.extent;
+    scissor.extent = extent;
     vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
-    currentPass = &pass;
-    return *this;
 }
 
 CommandBuffer& CommandBuffer::PushConstant(VkGraphicsRenderpass& pass, uint32_t size, const void* ptr) {
-    vkCmdPushConstants(this->commandBuffer, pass.GetPipeline().GetVkPipelineLayout(),
-                       VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0, size, ptr);
+    VkPipelineLayout layout = pass.GetPipeline().GetVkPipelineLayout();
+    if (layout == bindState.pushConstantLayout && size == bindState.pushConstantSize &&
+        memcmp(ptr, bindState.pushConstantData.data(), size) == 0) {
+        return *this;
+    }
+    vkCmdPushConstants(this->commandBuffer, layout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0,
+                       size, ptr);
+    if (size <= bindState.pushConstantData.size()) {
+        bindState.pushConstantLayout = layout;
+        bindState.pushConstantSize = size;
+        memcpy(bindState.pushConstantData.data(), ptr, size);
+    } else {
+        bindState.pushConstantLayout = VK_NULL_HANDLE;
+    }
     return *this;
 }
 
@@ -139,6 +232,25 @@ CommandBuffer& CommandBuffer::EndPass() {
     return *this;
 }
 
+CommandBuffer& CommandBuffer::BindGraphicsPipeline(VkPipeline pipeline) {
+    BindPipeline(VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+    return *this;
+}
+
+void CommandBuffer::BindPipeline(VkPipelineBindPoint bindPoint, VkPipeline pipeline) {
+    VkPipeline& bound =
+        bindPoint == VK_PIPELINE_BIND_POINT_COMPUTE ? bindState.computePipeline : bindState.graphicsPipeline;
+    if (bound == pipeline) {
+        return;
+    }
+    vkCmdBindPipeline(commandBuffer, bindPoint, pipeline);
+    bound = pipeline;
+}
+
+void CommandBuffer::ResetBindState() {
+    bindState = BindState{};
+}
+
 CommandBuffer& CommandBuffer::DrawIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex,
                                           uint32_t vertexOffset, uint32_t firstInstance) {
     vkCmdDrawIndexed(commandBuffer, indexCount, instanceCount, firstIndex, vertexOffset, firstInstance);
@@ -151,18 +263,78 @@ CommandBuffer& CommandBuffer::Draw(uint32_t vertexCount, uint32_t instanceCount,
     return *this;
 }
 
+CommandBuffer& CommandBuffer::DrawIndexedIndirect(VkBuffer buffer, VkDeviceSize offset, uint32_t drawCount,
+                                                  uint32_t stride) {
+    vkCmdDrawIndexedIndirect(commandBuffer, buffer, offset, drawCount, stride);
+    return *this;
+}
+
+CommandBuffer& CommandBuffer::Dispatch(Pipeline& pipeline,
+                                       const std::vector<std::unique_ptr<DescriptorSet>>& descriptorSets,
+                                       uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ) {
+    BindPipeline(VK_PIPELINE_BIND_POINT_COMPUTE, pipeline.GetVkPipeline());
+
+    std::vector<VkDescriptorSet> sets;
+    sets.reserve(descriptorSets.size());
+    for (const auto& descriptorSet : descriptorSets) {
+        sets.push_back(descriptorSet->GetVkDescriptorSet());
+    }
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline.GetVkPipelineLayout(), 0,
+                            sets.size(), sets.data(), 0, nullptr);
+
+    vkCmdDispatch(commandBuffer, groupCountX, groupCountY, groupCountZ);
+    return *this;
+}
+
+CommandBuffer& CommandBuffer::CopyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size) {
+    VkBufferCopy copyRegion{};
+    copyRegion.size = size;
+    vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
+    return *this;
+}
+
+CommandBuffer& CommandBuffer::BufferBarrier(VkBuffer buffer, VkPipelineStageFlags srcStageMask,
+                                            VkAccessFlags srcAccessMask, VkPipelineStageFlags dstStageMask,
+                                            VkAccessFlags dstAccessMask) {
+    VkBufferMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    barrier.srcAccessMask = srcAccessMask;
+    barrier.dstAccessMask = dstAccessMask;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.buffer = buffer;
+    barrier.offset = 0;
+    barrier.size = VK_WHOLE_SIZE;
+    PipelineBarrier(srcStageMask, dstStageMask, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+    return *this;
+}
+
 void CommandBuffer::EndRecord(VkSubmitInfo* submitInfo, VkFence fence) {
+    EndRecord();
+    Submit(submitInfo, fence);
+}
+
+void CommandBuffer::EndRecord(std::vector<VkSemaphore> waitSemaphores, std::vector<VkSemaphore> signalSemaphores,
+                              VkFence fence) {
+    EndRecord();
+    Submit(std::move(waitSemaphores), std::move(signalSemaphores), fence);
+}
+
+void CommandBuffer::EndRecord() {
     if (currentPass != nullptr) {
         vkCmdEndRenderPass(commandBuffer);
+        currentPass = nullptr;
     }
     vkEndCommandBuffer(commandBuffer);
+}
+
+void CommandBuffer::Submit(VkSubmitInfo* submitInfo, VkFence fence) {
     vkQueueSubmit(core.GetGraphicsQueue(), 1, submitInfo, fence);
     vkQueueWaitIdle(core.GetGraphicsQueue());
 }
 
-void CommandBuffer::EndRecord(std::vector<VkSemaphore> waitSemaphores, std::vector<VkSemaphore> signalSemaphores,
-                              VkFence fence) {
-
+void CommandBuffer::Submit(std::vector<VkSemaphore> waitSemaphores, std::vector<VkSemaphore> signalSemaphores,
+                           VkFence fence) {
     VkSubmitInfo submitInfo{};
     submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 
@@ -176,7 +348,7 @@ void CommandBuffer::EndRecord(std::vector<VkSemaphore> waitSemaphores, std::vect
     submitInfo.pWaitDstStageMask = waitStages;
     submitInfo.signalSemaphoreCount = signalSemaphores.size();
     submitInfo.pSignalSemaphores = signalSemaphores.data();
-    EndRecord(&submitInfo, fence);
+    Submit(&submitInfo, fence);
 }
 
 void CommandBuffer::BarrierBetweenPasses(uint32_t imageIndex, VkGraphicsRenderpass& pass) {
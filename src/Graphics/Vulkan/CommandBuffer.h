@@ -10,24 +10,49 @@ class CommandBuffer {
     static void EndSingleTimeCommands(CommandBuffer& commandBuffer);
 
    public:
-    CommandBuffer(VkCore& core);
+    // commandPool defaults to the core's pool, workers recording in parallel pass their own
+    CommandBuffer(VkCore& core, VkCommandBufferLevel level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+                  VkCommandPool commandPool = VK_NULL_HANDLE);
     ~CommandBuffer();
 
+    // binds and push constants are tracked, calls that would not change the current state are skipped
     CommandBuffer& BindVertexBuffer(int firstBinding, std::vector<VkBuffer> buffers, std::vector<VkDeviceSize> offsets);
+    CommandBuffer& BindVertexBuffer(VkBuffer buffer, VkDeviceSize offset = 0);
     CommandBuffer& BindIndexBuffer(VkBuffer indexBuffer, VkDeviceSize offset,
                                    VkIndexType indexType = VK_INDEX_TYPE_UINT16);
 
+    // switches to another pipeline of the current pass, e.g. a material variant
+    CommandBuffer& BindGraphicsPipeline(VkPipeline pipeline);
     CommandBuffer& BindDescriptorSets(VkGraphicsRenderpass& pass, uint32_t firstSet, uint32_t dynamicOffsetCount = 0,
                                       const uint32_t* pDynamicOffsets = nullptr);
     CommandBuffer& StartRecord();
-    CommandBuffer& StartPass(VkGraphicsRenderpass& pass, uint32_t imageIndex);
+    // with VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS the pass only accepts ExecuteCommands
+    CommandBuffer& StartPass(VkGraphicsRenderpass& pass, uint32_t imageIndex,
+                             VkSubpassContents contents = VK_SUBPASS_CONTENTS_INLINE);
+    // secondary command buffers continue the pass started on the primary one for the same image
+    CommandBuffer& StartSecondaryRecord(VkGraphicsRenderpass& pass, uint32_t imageIndex);
+    void EndSecondaryRecord();
+    CommandBuffer& ExecuteCommands(const std::vector<VkCommandBuffer>& secondaryCommandBuffers);
     CommandBuffer& EndPass();
     CommandBuffer& DrawIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, uint32_t vertexOffset,
                                uint32_t firstInstance);
     CommandBuffer& Draw(uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance);
+    CommandBuffer& DrawIndexedIndirect(VkBuffer buffer, VkDeviceSize offset, uint32_t drawCount = 1,
+                                       uint32_t stride = sizeof(VkDrawIndexedIndirectCommand));
     CommandBuffer& PushConstant(VkGraphicsRenderpass& pass, uint32_t size, const void* ptr);
+
+    // compute, has to be recorded outside of a pass
+    CommandBuffer& Dispatch(Pipeline& pipeline, const std::vector<std::unique_ptr<DescriptorSet>>& descriptorSets,
+                            uint32_t groupCountX, uint32_t groupCountY = 1, uint32_t groupCountZ = 1);
+    CommandBuffer& CopyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size);
+    CommandBuffer& BufferBarrier(VkBuffer buffer, VkPipelineStageFlags srcStageMask, VkAccessFlags srcAccessMask,
+                                 VkPipelineStageFlags dstStageMask, VkAccessFlags dstAccessMask);
     void EndRecord(VkSubmitInfo* submitInfo, VkFence fence);
     void EndRecord(std::vector<VkSemaphore> waitSemaphores, std::vector<VkSemaphore> signalSemaphores, VkFence fence);
+    // split variants for command buffers that are recorded once and submitted many times
+    void EndRecord();
+    void Submit(VkSubmitInfo* submitInfo, VkFence fence);
+    void Submit(std::vector<VkSemaphore> waitSemaphores, std::vector<VkSemaphore> signalSemaphores, VkFence fence);
 
     void BarrierBetweenPasses(uint32_t imageIndex, VkGraphicsRenderpass& pass);
 
@@ -39,10 +64,34 @@ class CommandBuffer {
 
     VkCommandBuffer& GetCommandBuffer() { return commandBuffer; }
 
+   private:
+    void BindPipeline(VkPipelineBindPoint bindPoint, VkPipeline pipeline);
+    void SetViewportAndScissor(VkExtent2D extent);
+    void ResetBindState();
+
    private:
     VkCore& core;
     VkGraphicsRenderpass* currentPass{nullptr};
+    VkCommandPool commandPool{VK_NULL_HANDLE};
     VkCommandBuffer commandBuffer{VK_NULL_HANDLE};
+
+    // last bound state, graphics and compute bind points are tracked separately
+    struct BindState {
+        VkPipeline graphicsPipeline{VK_NULL_HANDLE};
+        VkPipeline computePipeline{VK_NULL_HANDLE};
+        VkPipelineLayout descriptorLayout{VK_NULL_HANDLE};
+        uint32_t firstSet{0};
+        std::vector<VkDescriptorSet> descriptorSets;
+        std::vector<VkBuffer> vertexBuffers;
+        std::vector<VkDeviceSize> vertexOffsets;
+        VkBuffer indexBuffer{VK_NULL_HANDLE};
+        VkDeviceSize indexOffset{0};
+        VkIndexType indexType{VK_INDEX_TYPE_MAX_ENUM};
+        VkPipelineLayout pushConstantLayout{VK_NULL_HANDLE};
+        uint32_t pushConstantSize{0};
+        // 128 bytes is the push constant size every device supports
+        std::array<uint8_t, 128> pushConstantData{};
+    } bindState;
 };
 }    // namespace Graphics
 }    // namespace XRLib
@@ -9,11 +9,23 @@ DescriptorSet::DescriptorSet(VkCore& core, std::vector<DescriptorLayoutElement>&
 
 void DescriptorSet::Init() {
     bindings.resize(elements.size());
+    std::vector<VkDescriptorBindingFlags> bindingFlags(elements.size(), 0);
+    uint32_t bindlessCapacity = 0;
     for (int i = 0; i < elements.size(); ++i) {
         bindings[i].binding = i;
         bindings[i].descriptorType = elements[i].GetType();
         if (const auto images = std::get_if<std::vector<std::shared_ptr<Image>>>(&elements[i].data)) {
             bindings[i].descriptorCount = images->size();
+        } else if (const auto bindless = std::get_if<BindlessImages>(&elements[i].data)) {
+            if (i != elements.size() - 1) {
+                Util::ErrorPopup("Bindless images must be the last binding of a descriptor set");
+            }
+            bindlessCapacity = bindless->capacity;
+            bindings[i].descriptorCount = bindless->capacity;
+            // slots are written while frames sampling other slots of the set are still executing
+            bindingFlags[i] = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT |
+                              VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT |
+                              VK_DESCRIPTOR_BINDING_VARIABLE_DESCRIPTOR_COUNT_BIT;
         } else {
             bindings[i].descriptorCount = 1;
         }
@@ -22,20 +34,39 @@ void DescriptorSet::Init() {
     }
 
     VkResult result;
+    VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo{};
+    bindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+    bindingFlagsInfo.bindingCount = bindingFlags.size();
+    bindingFlagsInfo.pBindingFlags = bindingFlags.data();
+
     VkDescriptorSetLayoutCreateInfo layoutInfo{};
     layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
     layoutInfo.bindingCount = bindings.size();
     layoutInfo.pBindings = bindings.data();
+    if (bindlessCapacity != 0) {
+        layoutInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+        layoutInfo.pNext = &bindingFlagsInfo;
+    }
     if ((result = vkCreateDescriptorSetLayout(core.GetRenderDevice(), &layoutInfo, nullptr, &descriptorSetLayout)) !=
         VK_SUCCESS) {
         Util::ErrorPopup("Error create descriptor set layout");
     }
 
+    // bindless sets come from their own update after bind pool, sized by the device limits
+    VkDescriptorSetVariableDescriptorCountAllocateInfo variableCountInfo{};
+    variableCountInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_VARIABLE_DESCRIPTOR_COUNT_ALLOCATE_INFO;
+    variableCountInfo.descriptorSetCount = 1;
+    variableCountInfo.pDescriptorCounts = &bindlessCapacity;
+
     VkDescriptorSetAllocateInfo allocInfo{};
     allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
     allocInfo.descriptorPool = core.GetDescriptorPool();
     allocInfo.descriptorSetCount = 1;
     allocInfo.pSetLayouts = &descriptorSetLayout;
+    if (bindlessCapacity != 0) {
+        allocInfo.descriptorPool = core.GetBindlessDescriptorPool();
+        allocInfo.pNext = &variableCountInfo;
+    }
     if ((result = vkAllocateDescriptorSets(core.GetRenderDevice(), &allocInfo, &descriptorSet)) != VK_SUCCESS) {
         Util::ErrorPopup("Failed to allocate descriptor set");
     }
@@ -61,6 +92,14 @@ void DescriptorSet::Init() {
             descriptorWrites[i].descriptorCount = 1;
             descriptorWrites[i].pBufferInfo = &bufferInfos[i];
 
+        } else if (const auto dynamicUniform = std::get_if<DynamicUniform>(&elements[i].data)) {
+            bufferInfos[i].buffer = dynamicUniform->buffer->GetBuffer();
+            bufferInfos[i].offset = 0;
+            bufferInfos[i].range = dynamicUniform->range;
+
+            descriptorWrites[i].descriptorCount = 1;
+            descriptorWrites[i].pBufferInfo = &bufferInfos[i];
+
         } else if (const auto images = std::get_if<std::vector<std::shared_ptr<Image>>>(&elements[i].data)) {
             imageInfos[i].resize(images->size());
             for (int j = 0; j < imageInfos[i].size(); ++j) {
@@ -75,9 +114,28 @@ void DescriptorSet::Init() {
         }
     }
 
+    // bindless slots start unwritten
+    std::erase_if(descriptorWrites, [](const VkWriteDescriptorSet& write) { return write.descriptorCount == 0; });
     vkUpdateDescriptorSets(core.GetRenderDevice(), descriptorWrites.size(), descriptorWrites.data(), 0, nullptr);
 }
 
+void DescriptorSet::WriteImage(uint32_t binding, uint32_t arrayElement, Image& image) {
+    VkDescriptorImageInfo imageInfo{};
+    imageInfo.imageView = image.GetImageView();
+    imageInfo.sampler = image.GetSampler();
+    imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+    VkWriteDescriptorSet descriptorWrite{};
+    descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptorWrite.dstSet = descriptorSet;
+    descriptorWrite.dstBinding = binding;
+    descriptorWrite.dstArrayElement = arrayElement;
+    descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    descriptorWrite.descriptorCount = 1;
+    descriptorWrite.pImageInfo = &imageInfo;
+    vkUpdateDescriptorSets(core.GetRenderDevice(), 1, &descriptorWrite, 0, nullptr);
+}
+
 DescriptorSet::~DescriptorSet() {
     vkDestroyDescriptorSetLayout(core.GetRenderDevice(), descriptorSetLayout, nullptr);
 }
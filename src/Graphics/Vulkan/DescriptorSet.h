@@ -6,9 +6,20 @@
 namespace XRLib {
 namespace Graphics {
 
+// image array that is filled after binding, see TextureHeap. Must be the last element of its set
+struct BindlessImages {
+    uint32_t capacity;
+};
+
+// uniform buffer bound with a dynamic offset, range bytes are visible from the offset on. See UniformRing
+struct DynamicUniform {
+    std::shared_ptr<Buffer> buffer;
+    VkDeviceSize range;
+};
+
 struct DescriptorLayoutElement {
 
-    std::variant<std::shared_ptr<Buffer>, std::vector<std::shared_ptr<Image>>>
+    std::variant<std::shared_ptr<Buffer>, std::vector<std::shared_ptr<Image>>, BindlessImages, DynamicUniform>
         data;    //buffer or images can be shared to multiple descriptors
     VkShaderStageFlags stage = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
 
@@ -20,7 +31,12 @@ struct DescriptorLayoutElement {
                 return VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
         }
 
-        if (auto image = std::get_if<std::vector<std::shared_ptr<Image>>>(&data)) {
+        if (std::holds_alternative<DynamicUniform>(data)) {
+            return VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+        }
+
+        if (std::holds_alternative<std::vector<std::shared_ptr<Image>>>(data) ||
+            std::holds_alternative<BindlessImages>(data)) {
             return VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
         }
         return VK_DESCRIPTOR_TYPE_MAX_ENUM;
@@ -46,6 +62,16 @@ class DescriptorSet {
     void AllocatePushConstant(uint32_t size) { pushConstantSize = size; };
     uint32_t GetPushConstantSize() { return pushConstantSize; }
 
+    // every DynamicUniform binding takes one offset when the set is bound, in binding order
+    uint32_t GetDynamicOffsetCount() const {
+        return std::count_if(elements.begin(), elements.end(), [](const DescriptorLayoutElement& element) {
+            return std::holds_alternative<DynamicUniform>(element.data);
+        });
+    }
+
+    // writes one slot of a BindlessImages binding, the set may already be bound
+    void WriteImage(uint32_t binding, uint32_t arrayElement, Image& image);
+
    private:
     void Init();
 
@@ -55,6 +81,10 @@ class DescriptorSet {
             elements.push_back(DescriptorLayoutElement{arg});
         } else if constexpr (std::is_same_v<std::remove_reference_t<T>, std::vector<std::shared_ptr<Image>>>) {
             elements.push_back(DescriptorLayoutElement{arg});
+        } else if constexpr (std::is_same_v<std::remove_cvref_t<T>, BindlessImages>) {
+            elements.push_back(DescriptorLayoutElement{arg});
+        } else if constexpr (std::is_same_v<std::remove_cvref_t<T>, DynamicUniform>) {
+            elements.push_back(DescriptorLayoutElement{arg});
         } else {
             static_assert(always_false<T>::value, "Invalid argument type for DescriptorSet constructor");
         }
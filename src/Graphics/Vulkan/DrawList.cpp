@@ -0,0 +1,101 @@
+#include "DrawList.h"
+
+namespace XRLib {
+namespace Graphics {
+namespace {
+constexpr uint32_t radixBits = 8;
+constexpr uint32_t radixBuckets = 1 << radixBits;
+
+uint64_t Field(uint32_t value, uint32_t bits, uint32_t shift) {
+    return (static_cast<uint64_t>(value) & ((uint64_t{1} << bits) - 1)) << shift;
+}
+}    // namespace
+
+uint64_t DrawList::MakeKey(uint32_t pass, uint32_t pipeline, uint32_t material, uint32_t geometry, float viewDepth) {
+    // positive floats order like their bit patterns, the top bits are a coarse but monotonic depth
+    uint32_t depthBitsValue;
+    const float depth = std::max(viewDepth, 0.0f);
+    memcpy(&depthBitsValue, &depth, sizeof(depth));
+    depthBitsValue >>= 32 - depthBits;
+
+    uint32_t shift = 0;
+    uint64_t key = Field(geometry, geometryBits, shift);
+    key |= Field(depthBitsValue, depthBits, shift += geometryBits);
+    key |= Field(material, materialBits, shift += depthBits);
+    key |= Field(pipeline, pipelineBits, shift += materialBits);
+    key |= Field(pass, passBits, shift += pipelineBits);
+    return key;
+}
+
+void DrawList::Clear() {
+    entries.clear();
+    draws.clear();
+}
+
+void DrawList::Add(uint64_t key, const Draw& draw) {
+    entries.push_back({key, static_cast<uint32_t>(draws.size())});
+    draws.push_back(draw);
+}
+
+void DrawList::Sort() {
+    const size_t count = entries.size();
+    if (count < 2) {
+        return;
+    }
+
+    // a few thousand draws sort in microseconds, handing the passes to threads would cost more than it saves
+    std::array<size_t, radixBuckets> histogram;
+    scratch.resize(count);
+
+    for (uint32_t shift = 0; shift < 64; shift += radixBits) {
+        histogram.fill(0);
+        for (const auto& entry : entries) {
+            ++histogram[(entry.key >> shift) & (radixBuckets - 1)];
+        }
+
+        // every key shares this digit, the pass would not move anything
+        if (histogram[(entries[0].key >> shift) & (radixBuckets - 1)] == count) {
+            continue;
+        }
+
+        // exclusive prefix sum turns the counts into write offsets
+        size_t offset = 0;
+        for (auto& bucket : histogram) {
+            const size_t bucketCount = bucket;
+            bucket = offset;
+            offset += bucketCount;
+        }
+
+        for (const auto& entry : entries) {
+            scratch[histogram[(entry.key >> shift) & (radixBuckets - 1)]++] = entry;
+        }
+        entries.swap(scratch);
+    }
+
+    sortedDraws.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        sortedDraws[i] = draws[entries[i].index];
+        entries[i].index = static_cast<uint32_t>(i);
+    }
+    draws.swap(sortedDraws);
+}
+
+void DrawList::Record(CommandBuffer& commandBuffer, VkGraphicsRenderpass& pass, size_t first, size_t count) const {
+    const size_t end = first + std::min(count, draws.size() - std::min(first, draws.size()));
+    for (size_t i = first; i < end; ++i) {
+        const Draw& draw = draws[i];
+        const VkPipeline pipeline =
+            draw.pipeline != VK_NULL_HANDLE ? draw.pipeline : pass.GetPipeline().GetVkPipeline();
+        commandBuffer.BindGraphicsPipeline(pipeline)
+            .PushConstant(pass, sizeof(draw.pushConstants), &draw.pushConstants)
+            .BindVertexBuffer(draw.vertexBuffer)
+            .BindIndexBuffer(draw.indexBuffer, 0, draw.indexType);
+        if (draw.indirectBuffer != VK_NULL_HANDLE) {
+            commandBuffer.DrawIndexedIndirect(draw.indirectBuffer, draw.indirectOffset);
+        } else {
+            commandBuffer.DrawIndexed(draw.indexCount, draw.instanceCount, draw.firstIndex, 0, draw.firstInstance);
+        }
+    }
+}
+}    // namespace Graphics
+}    // namespace XRLib
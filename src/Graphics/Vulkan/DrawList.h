@@ -0,0 +1,63 @@
+#pragma once
+
+#include "CommandBuffer.h"
+#include "Graphics/Primitives.h"
+
+namespace XRLib {
+namespace Graphics {
+// Draws of one pass collected with a 64 bit sort key, sorted and replayed so consecutive draws share as much state
+// as possible. CommandBuffer skips the binds that did not change between two draws.
+class DrawList {
+   public:
+    struct Draw {
+        // pipeline variant of the pass, VK_NULL_HANDLE uses the pass's own pipeline
+        VkPipeline pipeline{VK_NULL_HANDLE};
+        Primitives::DrawPushConstants pushConstants{};
+        VkBuffer vertexBuffer{VK_NULL_HANDLE};
+        VkBuffer indexBuffer{VK_NULL_HANDLE};
+        VkIndexType indexType{VK_INDEX_TYPE_UINT16};
+        uint32_t indexCount{0};
+        uint32_t instanceCount{1};
+        uint32_t firstIndex{0};
+        uint32_t firstInstance{0};
+        // draws whose parameters are written by the gpu, e.g. culled meshlets
+        VkBuffer indirectBuffer{VK_NULL_HANDLE};
+        VkDeviceSize indirectOffset{0};
+    };
+
+    // key layout from the most significant bit: pass, pipeline, material, view depth, geometry.
+    // Every mesh has its own buffers, so geometry only orders draws of equal coarse depth.
+    // Fields wider than their bits wrap, which only costs sort quality, never correctness
+    inline constexpr static uint32_t passBits = 4;
+    inline constexpr static uint32_t pipelineBits = 8;
+    inline constexpr static uint32_t materialBits = 16;
+    inline constexpr static uint32_t depthBits = 20;
+    inline constexpr static uint32_t geometryBits = 16;
+    static_assert(passBits + pipelineBits + materialBits + depthBits + geometryBits == 64);
+
+    // within a material, depth sorts front to back, so opaque draws get the most out of early depth rejection
+    static uint64_t MakeKey(uint32_t pass, uint32_t pipeline, uint32_t material, uint32_t geometry, float viewDepth);
+
+    void Clear();
+    void Add(uint64_t key, const Draw& draw);
+    // stable least significant digit radix sort on the calling thread, digits all keys share are skipped
+    void Sort();
+    // records draws [first, first + count), ranges can be recorded into separate command buffers in parallel
+    void Record(CommandBuffer& commandBuffer, VkGraphicsRenderpass& pass, size_t first = 0,
+                size_t count = SIZE_MAX) const;
+
+    size_t Size() const { return draws.size(); }
+
+   private:
+    struct SortEntry {
+        uint64_t key;
+        uint32_t index;
+    };
+
+    std::vector<SortEntry> entries;
+    std::vector<SortEntry> scratch;
+    std::vector<Draw> draws;
+    std::vector<Draw> sortedDraws;
+};
+}    // namespace Graphics
+}    // namespace XRLib
@@ -3,11 +3,20 @@
 namespace XRLib {
 namespace Graphics {
 Pipeline::Pipeline(VkCore& core, Shader& vertexShader, Shader& fragmentShader, Renderpass& renderPass,
-                   const std::vector<std::unique_ptr<DescriptorSet>>& descriptorSets)
+                   const std::vector<std::unique_ptr<DescriptorSet>>& descriptorSets, const ShaderVariant& variant)
     : core{core} {
     VkPipelineShaderStageCreateInfo shaderStages[] = {vertexShader.GetShaderStageInfo(),
                                                       fragmentShader.GetShaderStageInfo()};
 
+    // entries for constant ids a custom shader does not declare are ignored
+    ShaderVariant::SpecializationData specializationData = variant.GetSpecializationData();
+    VkSpecializationInfo specializationInfo{};
+    specializationInfo.mapEntryCount = std::size(ShaderVariant::specializationEntries);
+    specializationInfo.pMapEntries = ShaderVariant::specializationEntries;
+    specializationInfo.dataSize = sizeof(specializationData);
+    specializationInfo.pData = &specializationData;
+    shaderStages[1].pSpecializationInfo = &specializationInfo;
+
     auto bindingDescription = VkUtil::GetVertexBindingDescription();
     auto attributeDescription = VkUtil::GetVertexAttributeDescription();
 
@@ -68,33 +77,7 @@ Pipeline::Pipeline(VkCore& core, Shader& vertexShader, Shader& fragmentShader, R
     dynamicState.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
     dynamicState.pDynamicStates = dynamicStates.data();
 
-    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
-    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-    pipelineLayoutInfo.pushConstantRangeCount = 0;
-
-    VkPushConstantRange pushConstantRange{};
-    if (!descriptorSets.empty()) {
-        for (const auto& descriptorSet : descriptorSets) {
-            if (descriptorSet != nullptr && descriptorSet->GetPushConstantSize() != 0) {
-                pushConstantRange.offset = 0;
-                pushConstantRange.size = descriptorSet->GetPushConstantSize();
-                pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
-                pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
-                pipelineLayoutInfo.pushConstantRangeCount = 1;
-            }
-        }
-    }
-
-    std::vector<VkDescriptorSetLayout> layouts(descriptorSets.size());
-    pipelineLayoutInfo.setLayoutCount = descriptorSets.size();
-    for (auto i = 0; i < descriptorSets.size(); ++i) {
-        layouts[i] = descriptorSets[i]->GetDescriptorSetLayout();
-    }
-    pipelineLayoutInfo.pSetLayouts = layouts.data();
-
-    if (vkCreatePipelineLayout(core.GetRenderDevice(), &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
-        throw std::runtime_error("failed to create pipeline layout!");
-    }
+    CreatePipelineLayout(descriptorSets, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT);
 
     VkPipelineDepthStencilStateCreateInfo depthStencil{};
     depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
@@ -122,12 +105,58 @@ Pipeline::Pipeline(VkCore& core, Shader& vertexShader, Shader& fragmentShader, R
     pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
     pipelineInfo.pDepthStencilState = &depthStencil;
 
-    if (vkCreateGraphicsPipelines(core.GetRenderDevice(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline) !=
-        VK_SUCCESS) {
+    if (vkCreateGraphicsPipelines(core.GetRenderDevice(), core.GetPipelineCache(), 1, &pipelineInfo, nullptr,
+                                  &pipeline) != VK_SUCCESS) {
         throw std::runtime_error("failed to create graphics pipeline!");
     }
+}
+
+Pipeline::Pipeline(VkCore& core, Shader& computeShader,
+                   const std::vector<std::unique_ptr<DescriptorSet>>& descriptorSets)
+    : core{core} {
+    CreatePipelineLayout(descriptorSets, VK_SHADER_STAGE_COMPUTE_BIT);
+
+    VkComputePipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.stage = computeShader.GetShaderStageInfo();
+    pipelineInfo.layout = pipelineLayout;
+    pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+
+    if (vkCreateComputePipelines(core.GetRenderDevice(), core.GetPipelineCache(), 1, &pipelineInfo, nullptr,
+                                 &pipeline) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create compute pipeline!");
+    }
+}
+
+void Pipeline::CreatePipelineLayout(const std::vector<std::unique_ptr<DescriptorSet>>& descriptorSets,
+                                    VkShaderStageFlags pushConstantStages) {
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.pushConstantRangeCount = 0;
+
+    VkPushConstantRange pushConstantRange{};
+    if (!descriptorSets.empty()) {
+        for (const auto& descriptorSet : descriptorSets) {
+            if (descriptorSet != nullptr && descriptorSet->GetPushConstantSize() != 0) {
+                pushConstantRange.offset = 0;
+                pushConstantRange.size = descriptorSet->GetPushConstantSize();
+                pushConstantRange.stageFlags = pushConstantStages;
+                pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+                pipelineLayoutInfo.pushConstantRangeCount = 1;
+            }
+        }
+    }
+
+    std::vector<VkDescriptorSetLayout> layouts(descriptorSets.size());
+    pipelineLayoutInfo.setLayoutCount = descriptorSets.size();
+    for (auto i = 0; i < descriptorSets.size(); ++i) {
+        layouts[i] = descriptorSets[i]->GetDescriptorSetLayout();
+    }
+    pipelineLayoutInfo.pSetLayouts = layouts.data();
 
-    renderPass.SetGraphicPipeline(&this->pipeline);
+    if (vkCreatePipelineLayout(core.GetRenderDevice(), &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create pipeline layout!");
+    }
 }
 
 Pipeline::~Pipeline() {
@@ -8,14 +8,21 @@ namespace XRLib {
 namespace Graphics {
 class Pipeline {
    public:
-    // TODO: compute pipeline
+    // variant supplies the specialization constants of the fragment stage
     Pipeline(VkCore& core, Shader& vertexShader, Shader& fragmentShader, Renderpass& pass,
-             const std::vector<std::unique_ptr<DescriptorSet>>& descriptorSets);
+             const std::vector<std::unique_ptr<DescriptorSet>>& descriptorSets, const ShaderVariant& variant = {});
+
+    // compute pipeline
+    Pipeline(VkCore& core, Shader& computeShader, const std::vector<std::unique_ptr<DescriptorSet>>& descriptorSets);
     ~Pipeline();
 
     VkPipeline& GetVkPipeline() { return pipeline; }
     VkPipelineLayout& GetVkPipelineLayout() { return pipelineLayout; }
 
+   private:
+    void CreatePipelineLayout(const std::vector<std::unique_ptr<DescriptorSet>>& descriptorSets,
+                              VkShaderStageFlags pushConstantStages);
+
    private:
     VkCore& core;
     VkPipeline pipeline{VK_NULL_HANDLE};
@@ -13,7 +13,6 @@ class Renderpass {
 
     VkRenderPass& GetVkRenderpass() { return pass; }
     const std::vector<VkFramebuffer>& GetFrameBuffers() { return frameBuffers; }
-    void SetGraphicPipeline(VkPipeline* pipeline) { graphicsPipeline = pipeline; }
 
     std::vector<std::vector<Image*>>& GetRenderTargets();
 
@@ -26,7 +25,6 @@ class Renderpass {
    private:
     VkCore& core;
     VkRenderPass pass{VK_NULL_HANDLE};
-    VkPipeline* graphicsPipeline{nullptr};
 
     std::vector<VkFramebuffer> frameBuffers;
     Image depthImage;
@@ -1,55 +1,119 @@
 #include "Shader.h"
+#include "ShaderCache.h"
 #include "VkStandardRB.h"
 
+#if __has_include(<glslang/build_info.h>)
+#include <glslang/build_info.h>
+#endif
+
+#ifndef XRLIB_SHADERC_VERSION
+#define XRLIB_SHADERC_VERSION "unknown"
+#endif
+
 namespace XRLib {
 namespace Graphics {
 
-Shader::Shader(VkCore& core, const std::filesystem::path& filePath, ShaderStage shaderStage, bool stereo)
-    : core{core}, stage{shaderStage} {
-    Util::EnsureDirExists(VkStandardRB::defaultShaderCachePath);
+static ShaderCache& GetShaderCache() {
+    static ShaderCache cache{std::filesystem::path{VkStandardRB::defaultShaderCachePath} / "shaders.cache"};
+    return cache;
+}
+
+// shaderc release from the build, plus the glslang version when its headers are reachable. The spirv version
+// alone stays the same across compiler releases that change the generated code
+static std::string CompilerVersion() {
+    std::string version = XRLIB_SHADERC_VERSION;
+#ifdef GLSLANG_VERSION_MAJOR
+    version += FORMAT_STRING("+glslang.{}.{}.{}", GLSLANG_VERSION_MAJOR, GLSLANG_VERSION_MINOR, GLSLANG_VERSION_PATCH);
+#endif
+    return version;
+}
+
+// everything that changes the compiled output, hashed into the cache key
+static std::string CacheKeyMaterial(const std::string& rawCode, Shader::ShaderStage stage, bool stereo,
+                                    const ShaderVariant& variant) {
+    unsigned int spvVersion = 0;
+    unsigned int spvRevision = 0;
+    shaderc_get_spv_version(&spvVersion, &spvRevision);
+    return FORMAT_STRING("stage={};stereo={};defines={};features={};optimization={};spirv={}.{};compiler={};\n{}",
+                         static_cast<int>(stage), stereo, Shader::CompileDefines(), variant.features,
+                         static_cast<int>(shaderc_optimization_level_performance), spvVersion, spvRevision,
+                         CompilerVersion(), rawCode);
+}
+
+Shader::Shader(VkCore& core, const std::filesystem::path& filePath, ShaderStage shaderStage, bool stereo,
+               std::string_view defaultCode, const ShaderVariant& variant)
+    : Shader{core, CompileAsync(filePath, shaderStage, stereo, defaultCode, variant), shaderStage} {}
+
+Shader::Shader(VkCore& core, SpirvFuture spirv, ShaderStage shaderStage) : core{core}, stage{shaderStage} {
+    Init(spirv.get());
+}
+
+Shader::SpirvFuture Shader::CompileAsync(const std::filesystem::path& filePath, ShaderStage stage, bool stereo,
+                                         std::string_view defaultCode, const ShaderVariant& variant) {
+    static std::mutex jobsMutex;
+    static std::unordered_map<std::string, SpirvFuture> jobs;
+
+    std::string key = FORMAT_STRING("{}|{}|{}|{}|{}", filePath.generic_string(), static_cast<int>(stage), stereo,
+                                    Util::Hash128(defaultCode)[0], variant.features);
+    std::lock_guard<std::mutex> lock{jobsMutex};
+    auto it = jobs.find(key);
+    if (it != jobs.end()) {
+        return it->second;
+    }
+
+    SpirvFuture job = std::async(std::launch::async, &Shader::LoadOrCompile, filePath, stage, stereo,
+                                 std::string{defaultCode}, variant)
+                          .share();
+    jobs.emplace(std::move(key), job);
+    return job;
+}
+
+std::vector<uint32_t> Shader::LoadOrCompile(const std::filesystem::path& filePath, ShaderStage stage, bool stereo,
+                                            const std::string& defaultCode, const ShaderVariant& variant) {
     std::string rawCode;
-    if (filePath.empty()) {
+    if (filePath.empty() && !defaultCode.empty()) {
+        rawCode = defaultCode;
+    } else if (filePath.empty()) {
         switch (stage) {
             case ShaderStage::VERTEX_SHADER:
                 rawCode = stereo ? VkStandardRB::defaultVertStereo : VkStandardRB::defaultVertFlat;
                 break;
             case ShaderStage::FRAGMENT_SHADER:
-                //rawCode = VkStandardRB::defaultPhongFrag;
-                rawCode = VkStandardRB::defaultPBRFrag;
+                rawCode = variant.Has(ShaderVariant::PHONG) ? VkStandardRB::defaultPhongFrag
+                                                            : VkStandardRB::defaultPBRFrag;
+                break;
+            case ShaderStage::COMPUTE_SHADER:
+                // no single default compute shader, callers pass their source
                 break;
         }
     } else {
         rawCode = Util::ReadFile(filePath.generic_string());
     }
 
-    std::string cacheNamePrefix = filePath.empty() ? "defaultMain" : filePath.filename().generic_string();
-    std::string cacheNameSuffix = std::to_string(Util::HashString(rawCode));
-
-    std::string cacheFilePath =
-        FORMAT_STRING("{}/{}_{}.spv", VkStandardRB::defaultShaderCachePath, cacheNamePrefix, cacheNameSuffix);
+    std::string shaderName = filePath.empty() ? "defaultMain" : filePath.filename().generic_string();
+    ShaderCache::Key key = Util::Hash128(CacheKeyMaterial(rawCode, stage, stereo, variant));
 
     std::vector<uint32_t> code;
-    if (std::filesystem::exists(cacheFilePath)) {
-        code = Util::ReadBinaryFile(cacheFilePath);
-        LOGGER(LOGGER::INFO) << "Loaded shader from cache: " << cacheFilePath;
+    if (GetShaderCache().Find(key, code)) {
+        LOGGER(LOGGER::INFO) << "Loaded shader from cache: " << shaderName;
     } else {
 
         if (rawCode.empty()) {
             Util::ErrorPopup("Shader file content is empty");
         }
 
-        code = Compile(rawCode, cacheNamePrefix);
-        Util::WriteFile(cacheFilePath, code);
-        LOGGER(LOGGER::INFO) << "Compiled and cached shader: " << cacheFilePath;
+        code = Compile(rawCode, shaderName, stage, stereo, variant);
+        GetShaderCache().Store(key, code);
+        LOGGER(LOGGER::INFO) << "Compiled and cached shader: " << shaderName;
     }
-    Init(code);
+    return code;
 }
 
 Shader::~Shader() {
     VkUtil::VkSafeClean(vkDestroyShaderModule, core.GetRenderDevice(), this->shaderModule, nullptr);
 }
 
-void Shader::Init(std::vector<uint32_t> spirv) {
+void Shader::Init(const std::vector<uint32_t>& spirv) {
     // create shader module
     VkShaderModuleCreateInfo createInfo{};
     createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
@@ -66,20 +130,33 @@ void Shader::Init(std::vector<uint32_t> spirv) {
     this->shaderStageInfo.pName = "main";
 }
 
-std::vector<uint32_t> Shader::Compile(std::string content, std::string name) {
+std::vector<uint32_t> Shader::Compile(const std::string& content, const std::string& name, ShaderStage stage,
+                                      bool stereo, const ShaderVariant& variant) {
     shaderc::Compiler compiler;
     shaderc::CompileOptions options;
 
     options.SetOptimizationLevel(shaderc_optimization_level_performance);
+#ifdef XRLIB_QUANTIZED_VERTICES
+    options.AddMacroDefinition("XRLIB_QUANTIZED_VERTICES");
+#endif
+    if (stereo) {
+        options.AddMacroDefinition("XRLIB_STEREO");
+    }
+    for (const auto& define : variant.Defines()) {
+        options.AddMacroDefinition(define);
+    }
 
     shaderc_shader_kind shader_kind{shaderc_glsl_vertex_shader};
-    switch (this->stage) {
+    switch (stage) {
         case ShaderStage::VERTEX_SHADER:
             shader_kind = shaderc_glsl_vertex_shader;
             break;
         case ShaderStage::FRAGMENT_SHADER:
             shader_kind = shaderc_glsl_fragment_shader;
             break;
+        case ShaderStage::COMPUTE_SHADER:
+            shader_kind = shaderc_glsl_compute_shader;
+            break;
     }
     shaderc::SpvCompilationResult module = compiler.CompileGlslToSpv(content, shader_kind, name.c_str(), options);
 
@@ -7,22 +7,92 @@
 
 namespace XRLib {
 namespace Graphics {
+// permutation of the default shaders. Features turn into preprocessor defines and are part of the cache key, so
+// unused texture fetches and branches are compiled out. Tunables are specialization constants of the fragment stage
+struct ShaderVariant {
+    enum Feature : uint32_t {
+        NORMAL_MAP = 1 << 0,
+        EMISSIVE = 1 << 1,
+        ALPHA_TEST = 1 << 2,
+        UNLIT = 1 << 3,
+        PHONG = 1 << 4,    // blinn phong lighting instead of pbr
+    };
+
+    uint32_t features{NORMAL_MAP | EMISSIVE};
+    uint32_t maxLights{64};    // constant_id 0, upper bound of the per fragment light loop
+    float alphaCutoff{0.5f};   // constant_id 1 for custom shaders, the default ones read it from the material
+
+    bool Has(Feature feature) const { return (features & feature) != 0; }
+    bool operator==(const ShaderVariant& other) const = default;
+
+    std::vector<std::string> Defines() const {
+        std::vector<std::string> defines;
+        constexpr std::pair<Feature, const char*> featureDefines[] = {{NORMAL_MAP, "XRLIB_NORMAL_MAP"},
+                                                                      {EMISSIVE, "XRLIB_EMISSIVE"},
+                                                                      {ALPHA_TEST, "XRLIB_ALPHA_TEST"},
+                                                                      {UNLIT, "XRLIB_UNLIT"},
+                                                                      {PHONG, "XRLIB_PHONG"}};
+        for (const auto& [feature, define] : featureDefines) {
+            if (Has(feature)) {
+                defines.push_back(define);
+            }
+        }
+        return defines;
+    }
+
+    struct SpecializationData {
+        uint32_t maxLights;
+        float alphaCutoff;
+    };
+    SpecializationData GetSpecializationData() const { return {maxLights, alphaCutoff}; }
+
+    inline constexpr static VkSpecializationMapEntry specializationEntries[] = {
+        {0, offsetof(SpecializationData, maxLights), sizeof(uint32_t)},
+        {1, offsetof(SpecializationData, alphaCutoff), sizeof(float)}};
+};
+
 class Shader {
    public:
     enum ShaderStage {
         VERTEX_SHADER = VK_SHADER_STAGE_VERTEX_BIT,
         FRAGMENT_SHADER = VK_SHADER_STAGE_FRAGMENT_BIT,
+        COMPUTE_SHADER = VK_SHADER_STAGE_COMPUTE_BIT,
         // possibly more
     };
-    Shader(VkCore& core, const std::filesystem::path& file_path, ShaderStage stage, bool stereo);
+    using SpirvFuture = std::shared_future<std::vector<uint32_t>>;
+
+    // defaultCode replaces the built in default source when file_path is empty
+    Shader(VkCore& core, const std::filesystem::path& file_path, ShaderStage stage, bool stereo,
+           std::string_view defaultCode = {}, const ShaderVariant& variant = {});
+    // waits for spirv requested through CompileAsync
+    Shader(VkCore& core, SpirvFuture spirv, ShaderStage stage);
     ~Shader();
 
+    // loads or compiles the spirv on a worker thread. Requests for the same source share one compilation, so
+    // shaders can be requested early to overlap compilation with other startup work such as mesh import
+    static SpirvFuture CompileAsync(const std::filesystem::path& file_path, ShaderStage stage, bool stereo,
+                                    std::string_view defaultCode = {}, const ShaderVariant& variant = {});
+
     VkShaderModule GetShaderModule() const { return shaderModule; };
     VkPipelineShaderStageCreateInfo GetShaderStageInfo() const { return shaderStageInfo; }
 
+    // macros defined for every compiled shader, mirrors the vertex layout chosen at build time
+    static constexpr std::string_view CompileDefines() {
+#ifdef XRLIB_QUANTIZED_VERTICES
+        return "XRLIB_QUANTIZED_VERTICES";
+#else
+        return "";
+#endif
+    }
+
    private:
-    void Init(std::vector<uint32_t> spirv);
-    std::vector<uint32_t> Compile(std::string content, std::string name);
+    void Init(const std::vector<uint32_t>& spirv);
+    static std::vector<uint32_t> LoadOrCompile(const std::filesystem::path& filePath, ShaderStage stage,
+                                               bool stereo, const std::string& defaultCode,
+                                               const ShaderVariant& variant);
+    // XRLIB_STEREO is defined for stereo shaders, flat shaders must not use gl_ViewIndex
+    static std::vector<uint32_t> Compile(const std::string& content, const std::string& name, ShaderStage stage,
+                                         bool stereo, const ShaderVariant& variant);
 
    private:
     VkCore& core;
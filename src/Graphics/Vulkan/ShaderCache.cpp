@@ -0,0 +1,169 @@
+#include "ShaderCache.h"
+
+namespace XRLib {
+namespace Graphics {
+
+ShaderCache::ShaderCache(const std::filesystem::path& archivePath) : archivePath{archivePath} {
+    Util::EnsureDirExists(archivePath.parent_path());
+    Load();
+}
+
+ShaderCache::~ShaderCache() {
+    CompactIfStale();
+}
+
+bool ShaderCache::Find(const Key& key, std::vector<uint32_t>& spirv) {
+    std::lock_guard<std::mutex> lock{mutex};
+    auto it = entries.find(key);
+    if (it == entries.end()) {
+        return false;
+    }
+    it->second.used = true;
+    spirv = it->second.spirv;
+    return true;
+}
+
+void ShaderCache::Store(const Key& key, const std::vector<uint32_t>& spirv) {
+    std::lock_guard<std::mutex> lock{mutex};
+    if (entries.contains(key)) {
+        return;
+    }
+
+    // header and payload go out in a single write, a partial record is rejected on the next load
+    std::vector<char> record = MakeRecord(key, spirv);
+    std::ofstream file(archivePath, std::ios::binary | std::ios::app);
+    file.write(record.data(), record.size());
+    file.flush();
+    if (!file.good()) {
+        LOGGER(LOGGER::WARNING) << "Failed to append to shader cache: " << archivePath.generic_string();
+    }
+    entries.emplace(key, Entry{spirv, true});
+}
+
+std::vector<char> ShaderCache::MakeRecord(const Key& key, const std::vector<uint32_t>& spirv) {
+    const size_t payloadSize = spirv.size() * sizeof(uint32_t);
+    RecordHeader header{recordMagic, static_cast<uint32_t>(payloadSize), key,
+                        Util::Hash128({reinterpret_cast<const char*>(spirv.data()), payloadSize})[0]};
+
+    std::vector<char> record(sizeof(RecordHeader) + payloadSize);
+    std::memcpy(record.data(), &header, sizeof(RecordHeader));
+    std::memcpy(record.data() + sizeof(RecordHeader), spirv.data(), payloadSize);
+    return record;
+}
+
+void ShaderCache::CompactIfStale() {
+    std::lock_guard<std::mutex> lock{mutex};
+    size_t staleRecords = 0;
+    size_t staleBytes = 0;
+    size_t usedBytes = 0;
+    for (const auto& [key, entry] : entries) {
+        const size_t bytes = sizeof(RecordHeader) + entry.spirv.size() * sizeof(uint32_t);
+        if (entry.used) {
+            usedBytes += bytes;
+        } else {
+            ++staleRecords;
+            staleBytes += bytes;
+        }
+    }
+    // variants a run did not request, e.g. stereo shaders in a flat run, are still valid. Only rewrite once the
+    // stale part dominates, a dropped variant that is requested again costs one compilation
+    if (staleRecords < compactMinStaleRecords || staleBytes < usedBytes) {
+        return;
+    }
+
+    ArchiveHeader header{};
+    std::memcpy(header.magic, archiveMagic, sizeof(archiveMagic));
+    header.version = archiveVersion;
+
+    // write next to the archive and rename, so a crash never leaves a truncated archive behind
+    std::filesystem::path tempPath = archivePath;
+    tempPath += ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(ArchiveHeader));
+        for (const auto& [key, entry] : entries) {
+            if (entry.used) {
+                std::vector<char> record = MakeRecord(key, entry.spirv);
+                file.write(record.data(), record.size());
+            }
+        }
+        if (!file.good()) {
+            LOGGER(LOGGER::WARNING) << "Failed to compact shader cache: " << archivePath.generic_string();
+            return;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tempPath, archivePath, ec);
+    if (ec) {
+        LOGGER(LOGGER::WARNING) << "Failed to replace shader cache: " << ec.message();
+        return;
+    }
+    LOGGER(LOGGER::INFO) << "Compacted shader cache, dropped " << staleRecords << " stale shaders";
+}
+
+void ShaderCache::Load() {
+    std::ifstream file(archivePath, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        Reset();
+        return;
+    }
+
+    std::vector<char> data(static_cast<size_t>(file.tellg()));
+    file.seekg(0, std::ios::beg);
+    file.read(data.data(), data.size());
+    file.close();
+
+    ArchiveHeader archiveHeader{};
+    if (data.size() < sizeof(ArchiveHeader)) {
+        Reset();
+        return;
+    }
+    std::memcpy(&archiveHeader, data.data(), sizeof(ArchiveHeader));
+    if (std::memcmp(archiveHeader.magic, archiveMagic, sizeof(archiveMagic)) != 0 ||
+        archiveHeader.version != archiveVersion) {
+        LOGGER(LOGGER::WARNING) << "Shader cache format changed, rebuilding: " << archivePath.generic_string();
+        Reset();
+        return;
+    }
+
+    size_t offset = sizeof(ArchiveHeader);
+    while (offset + sizeof(RecordHeader) <= data.size()) {
+        RecordHeader header{};
+        std::memcpy(&header, data.data() + offset, sizeof(RecordHeader));
+        const size_t payloadOffset = offset + sizeof(RecordHeader);
+        if (header.magic != recordMagic || header.payloadSize % sizeof(uint32_t) != 0 ||
+            payloadOffset + header.payloadSize > data.size() ||
+            Util::Hash128({data.data() + payloadOffset, header.payloadSize})[0] != header.payloadHash) {
+            break;
+        }
+
+        std::vector<uint32_t> spirv(header.payloadSize / sizeof(uint32_t));
+        std::memcpy(spirv.data(), data.data() + payloadOffset, header.payloadSize);
+        entries.emplace(header.key, Entry{std::move(spirv), false});
+        offset = payloadOffset + header.payloadSize;
+    }
+
+    // drop a damaged tail, later appends would be unreachable behind it
+    if (offset != data.size()) {
+        LOGGER(LOGGER::WARNING) << "Discarding damaged shader cache tail: " << archivePath.generic_string();
+        std::error_code ec;
+        std::filesystem::resize_file(archivePath, offset, ec);
+    }
+    LOGGER(LOGGER::INFO) << "Loaded " << entries.size() << " shaders from cache: " << archivePath.generic_string();
+}
+
+void ShaderCache::Reset() {
+    entries.clear();
+    ArchiveHeader header{};
+    std::memcpy(header.magic, archiveMagic, sizeof(archiveMagic));
+    header.version = archiveVersion;
+
+    std::ofstream file(archivePath, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(ArchiveHeader));
+    if (!file.good()) {
+        LOGGER(LOGGER::WARNING) << "Failed to create shader cache: " << archivePath.generic_string();
+    }
+}
+}    // namespace Graphics
+}    // namespace XRLib
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "Logger.h"
+#include "Utils/Util.h"
+
+namespace XRLib {
+namespace Graphics {
+// All compiled shader variants packed in one append only archive. The archive is read once when opened and
+// indexed by a 128 bit key, so lookups never touch the file system. Records carry their size and a payload hash,
+// a record cut short by a crash is dropped on the next open instead of being returned.
+// Records of edited shaders or old compiler versions are never looked up again. When the cache is destroyed and
+// the records not used during the run outweigh the used ones, the archive is rewritten with the used ones only.
+class ShaderCache {
+   public:
+    using Key = std::array<uint64_t, 2>;
+
+    explicit ShaderCache(const std::filesystem::path& archivePath);
+    ~ShaderCache();
+
+    bool Find(const Key& key, std::vector<uint32_t>& spirv);
+    void Store(const Key& key, const std::vector<uint32_t>& spirv);
+
+   private:
+    struct ArchiveHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t reserved;
+    };
+
+    struct RecordHeader {
+        uint32_t magic;
+        uint32_t payloadSize;
+        Key key;
+        uint64_t payloadHash;
+    };
+
+    struct Entry {
+        std::vector<uint32_t> spirv;
+        bool used{false};
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const { return static_cast<size_t>(key[0] ^ key[1]); }
+    };
+
+    inline constexpr static char archiveMagic[8] = {'X', 'R', 'S', 'H', 'A', 'D', 'E', 'R'};
+    inline constexpr static uint32_t archiveVersion = 1;
+    inline constexpr static uint32_t recordMagic = 0x52485358;
+    // fewer stale records than this are left in place, compaction rewrites the whole archive
+    inline constexpr static size_t compactMinStaleRecords = 32;
+
+    void Load();
+    void Reset();
+    void CompactIfStale();
+    static std::vector<char> MakeRecord(const Key& key, const std::vector<uint32_t>& spirv);
+
+   private:
+    std::filesystem::path archivePath;
+    std::mutex mutex;
+    std::unordered_map<Key, Entry, KeyHash> entries;
+};
+}    // namespace Graphics
+}    // namespace XRLib
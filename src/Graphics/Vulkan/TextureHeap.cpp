@@ -0,0 +1,46 @@
+#include "TextureHeap.h"
+
+namespace XRLib {
+namespace Graphics {
+uint32_t TextureHeap::Add(std::shared_ptr<Image> image) {
+    std::lock_guard<std::mutex> lock{mutex};
+    uint32_t slot;
+    if (!freeSlots.empty()) {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    } else if (images.size() < capacity) {
+        slot = static_cast<uint32_t>(images.size());
+        images.emplace_back();
+    } else {
+        Util::ErrorPopup(FORMAT_STRING("Texture heap is full, capacity {}", capacity));
+        return 0;
+    }
+
+    descriptorSet.WriteImage(binding, slot, *image);
+    images[slot] = std::move(image);
+    return slot;
+}
+
+void TextureHeap::Remove(uint32_t slot) {
+    std::lock_guard<std::mutex> lock{mutex};
+    if (slot >= images.size() || images[slot] == nullptr) {
+        LOGGER(LOGGER::WARNING) << "Removing empty texture heap slot " << slot;
+        return;
+    }
+    pendingReleases.push_back({currentFrame, slot, std::move(images[slot])});
+}
+
+uint64_t TextureHeap::BeginFrame() {
+    std::lock_guard<std::mutex> lock{mutex};
+    return ++currentFrame;
+}
+
+void TextureHeap::ReleaseCompleted(uint64_t completedFrame) {
+    std::lock_guard<std::mutex> lock{mutex};
+    while (!pendingReleases.empty() && pendingReleases.front().frame <= completedFrame) {
+        freeSlots.push_back(pendingReleases.front().slot);
+        pendingReleases.pop_front();
+    }
+}
+}    // namespace Graphics
+}    // namespace XRLib
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "DescriptorSet.h"
+
+namespace XRLib {
+namespace Graphics {
+// Slot allocator over a BindlessImages binding. Shaders index the table with the slot returned by Add, so textures
+// can be added or evicted at runtime without recreating descriptor sets. The descriptor set is owned by the pass
+// that binds it, the heap keeps the images alive while they occupy a slot.
+class TextureHeap {
+   public:
+    TextureHeap(DescriptorSet& descriptorSet, uint32_t binding, uint32_t capacity)
+        : descriptorSet{descriptorSet}, binding{binding}, capacity{capacity} {}
+
+    uint32_t Add(std::shared_ptr<Image> image);
+    // frames begun so far may still sample the slot, the image and the slot are released once they completed
+    void Remove(uint32_t slot);
+
+    // called by the renderer when it starts recording a frame, returns the frame's number
+    uint64_t BeginFrame();
+    // called after waiting for the frame fence, releases what was removed up to frame completedFrame
+    void ReleaseCompleted(uint64_t completedFrame);
+
+    uint32_t Capacity() const { return capacity; }
+    uint32_t Size() const { return static_cast<uint32_t>(images.size() - freeSlots.size()); }
+
+   private:
+    struct PendingRelease {
+        uint64_t frame;
+        uint32_t slot;
+        std::shared_ptr<Image> image;
+    };
+
+   private:
+    DescriptorSet& descriptorSet;
+    uint32_t binding;
+    uint32_t capacity;
+    std::vector<std::shared_ptr<Image>> images;
+    std::vector<uint32_t> freeSlots;
+    std::deque<PendingRelease> pendingReleases;    // ordered by frame
+    uint64_t currentFrame{0};
+    std::mutex mutex;
+};
+}    // namespace Graphics
+}    // namespace XRLib
@@ -0,0 +1,33 @@
+#include "UniformRing.h"
+
+namespace XRLib {
+namespace Graphics {
+UniformRing::UniformRing(VkCore& core, uint32_t regionCount, VkDeviceSize regionSize) : regionCount{regionCount} {
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(core.GetRenderPhysicalDevice(), &properties);
+    alignment = std::max<VkDeviceSize>(properties.limits.minUniformBufferOffsetAlignment, 1);
+    this->regionSize = (regionSize + alignment - 1) / alignment * alignment;
+
+    // zero initialized so a region that is bound before its first write holds valid matrices
+    std::vector<uint8_t> initialData(this->regionSize * regionCount, 0);
+    buffer = std::make_shared<Buffer>(core, initialData.size(), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+                                      static_cast<void*>(initialData.data()), false);
+}
+
+void UniformRing::BeginFrame(uint32_t region) {
+    regionBegin = (region % regionCount) * regionSize;
+    head = 0;
+}
+
+uint32_t UniformRing::Allocate(VkDeviceSize size, const void* data) {
+    if (head + size > regionSize) {
+        Util::ErrorPopup(FORMAT_STRING("Uniform ring region of {} bytes is full", regionSize));
+        return 0;
+    }
+    const VkDeviceSize offset = regionBegin + head;
+    memcpy(static_cast<uint8_t*>(buffer->GetMappedData()) + offset, data, size);
+    head += (size + alignment - 1) / alignment * alignment;
+    return static_cast<uint32_t>(offset);
+}
+}    // namespace Graphics
+}    // namespace XRLib
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "Buffer.h"
+
+namespace XRLib {
+namespace Graphics {
+// Persistently mapped uniform buffer split into one region per frame slot. Per frame data is written with Allocate
+// and bound through a dynamic uniform descriptor at the returned offset, so updates are plain memcpys instead of
+// queue submissions. Allocations in the same order land on the same offsets every frame, which keeps recorded
+// command buffers of a slot valid.
+class UniformRing {
+   public:
+    UniformRing(VkCore& core, uint32_t regionCount, VkDeviceSize regionSize);
+
+    // starts writing the region of the given frame slot, e.g. the swapchain image index
+    void BeginFrame(uint32_t region);
+    // copies data into the current region and returns its dynamic offset
+    uint32_t Allocate(VkDeviceSize size, const void* data);
+
+    std::shared_ptr<Buffer> GetBuffer() { return buffer; }
+    uint32_t RegionCount() const { return regionCount; }
+
+   private:
+    VkDeviceSize alignment{256};
+    VkDeviceSize regionSize;
+    uint32_t regionCount;
+    VkDeviceSize regionBegin{0};
+    VkDeviceSize head{0};
+    std::shared_ptr<Buffer> buffer;
+};
+}    // namespace Graphics
+}    // namespace XRLib
@@ -11,8 +11,18 @@ VkCore::~VkCore() {
         vkDestroyDebugUtilsMessengerEXT(GetRenderInstance(), vkDebugMessenger, nullptr);
     }
 
+    if (pipelineCache != VK_NULL_HANDLE) {
+        SavePipelineCache();
+    }
+    VkUtil::VkSafeClean(vkDestroyPipelineCache, vkDevice, pipelineCache, nullptr);
     VkUtil::VkSafeClean(vkDestroyCommandPool, vkDevice, commandPool, nullptr);
+    for (auto& imagePools : recordingCommandPools) {
+        for (auto& pool : imagePools) {
+            VkUtil::VkSafeClean(vkDestroyCommandPool, vkDevice, pool, nullptr);
+        }
+    }
     VkUtil::VkSafeClean(vkDestroyDescriptorPool, vkDevice, descriptorPool, nullptr);
+    VkUtil::VkSafeClean(vkDestroyDescriptorPool, vkDevice, bindlessDescriptorPool, nullptr);
 
     VkUtil::VkSafeClean(vkDestroySemaphore, vkDevice, imageAvailableSemaphore, nullptr);
     VkUtil::VkSafeClean(vkDestroySemaphore, vkDevice, renderFinishedSemaphore, nullptr);
@@ -191,6 +201,8 @@ void VkCore::CreateVkDevice(Config& config, const std::vector<const char*>& addi
     indexingFeatures.runtimeDescriptorArray = VK_TRUE;
     indexingFeatures.descriptorBindingPartiallyBound = VK_TRUE;
     indexingFeatures.descriptorBindingVariableDescriptorCount = VK_TRUE;
+    indexingFeatures.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+    indexingFeatures.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
 
     // TODO: remove after switching to XR_KHR_vulkan_enable2
     VkPhysicalDeviceTimelineSemaphoreFeatures timelineSemaphoreFeatures{};
@@ -213,10 +225,18 @@ void VkCore::CreateVkDevice(Config& config, const std::vector<const char*>& addi
     deviceCreateInfo.ppEnabledExtensionNames = deviceExtensions.data();
     deviceCreateInfo.pNext = &indexingFeatures;
 
+    // optional core features, users check GetEnabledFeatures before relying on them
+    VkPhysicalDeviceFeatures supportedFeatures{};
+    vkGetPhysicalDeviceFeatures(GetRenderPhysicalDevice(), &supportedFeatures);
+    enabledFeatures.drawIndirectFirstInstance = supportedFeatures.drawIndirectFirstInstance;
+    deviceCreateInfo.pEnabledFeatures = &enabledFeatures;
+
+    // prepended to the chain, replacing pNext would drop the descriptor indexing features
     VkPhysicalDeviceMultiviewFeaturesKHR physicalDeviceMultiviewFeatures{};
     if (xr) {
         physicalDeviceMultiviewFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MULTIVIEW_FEATURES_KHR;
         physicalDeviceMultiviewFeatures.multiview = VK_TRUE;
+        physicalDeviceMultiviewFeatures.pNext = &indexingFeatures;
         deviceCreateInfo.pNext = &physicalDeviceMultiviewFeatures;
     }
 
@@ -225,6 +245,7 @@ void VkCore::CreateVkDevice(Config& config, const std::vector<const char*>& addi
     }
 
     vkGetDeviceQueue(GetRenderDevice(), GetGraphicsQueueFamilyIndex(), 0, &graphicsQueue);
+    CreatePipelineCache();
 }
 
 uint32_t VkCore::GetMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) {
@@ -259,16 +280,27 @@ void VkCore::CreateFence(VkFence& fence) {
     }
 }
 
-void VkCore::CreateCommandPool() {
+void VkCore::CreateCommandPool(VkCommandPool& pool) {
     auto graphicsFamilyIndex = GetGraphicsQueueFamilyIndex();
     VkCommandPoolCreateInfo poolInfo{};
     poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
     poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
     poolInfo.queueFamilyIndex = graphicsFamilyIndex;
-    if (vkCreateCommandPool(GetRenderDevice(), &poolInfo, nullptr, &commandPool) != VK_SUCCESS) {
+    if (vkCreateCommandPool(GetRenderDevice(), &poolInfo, nullptr, &pool) != VK_SUCCESS) {
         Util::ErrorPopup("failed to create command pool!");
     }
 }
+void VkCore::ResetRecordingCommandPools(uint32_t imageIndex) {
+    if (imageIndex >= recordingCommandPools.size()) {
+        return;
+    }
+    for (auto pool : recordingCommandPools[imageIndex]) {
+        if (pool != VK_NULL_HANDLE) {
+            vkResetCommandPool(GetRenderDevice(), pool, 0);
+        }
+    }
+}
+
 void VkCore::CreateDescriptorPool() {
     VkDescriptorPoolSize poolSizes[] = {{VK_DESCRIPTOR_TYPE_SAMPLER, 20},
                                         {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 20},
@@ -288,5 +320,106 @@ void VkCore::CreateDescriptorPool() {
     poolInfo.maxSets = 100;
     if (vkCreateDescriptorPool(GetRenderDevice(), &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS) {}
 }
+
+uint32_t VkCore::GetBindlessTextureCapacity() {
+    VkPhysicalDeviceDescriptorIndexingProperties indexingProperties{};
+    indexingProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES;
+    VkPhysicalDeviceProperties2 properties{};
+    properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+    properties.pNext = &indexingProperties;
+    vkGetPhysicalDeviceProperties2(GetRenderPhysicalDevice(), &properties);
+
+    return std::min({maxBindlessTextures, indexingProperties.maxDescriptorSetUpdateAfterBindSampledImages,
+                     indexingProperties.maxDescriptorSetUpdateAfterBindSamplers,
+                     indexingProperties.maxPerStageDescriptorUpdateAfterBindSampledImages,
+                     indexingProperties.maxPerStageDescriptorUpdateAfterBindSamplers});
+}
+
+void VkCore::CreateBindlessDescriptorPool() {
+    VkDescriptorPoolSize poolSize{VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+                                  GetBindlessTextureCapacity() * maxBindlessSets};
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+    poolInfo.maxSets = maxBindlessSets;
+    if (vkCreateDescriptorPool(GetRenderDevice(), &poolInfo, nullptr, &bindlessDescriptorPool) != VK_SUCCESS) {
+        Util::ErrorPopup("Failed to create bindless descriptor pool");
+    }
+}
+
+void VkCore::CreatePipelineCache() {
+    std::vector<char> initialData;
+    std::ifstream file(std::filesystem::path{pipelineCachePath}, std::ios::binary | std::ios::ate);
+    if (file.is_open()) {
+        initialData.resize(static_cast<size_t>(file.tellg()));
+        file.seekg(0, std::ios::beg);
+        file.read(initialData.data(), initialData.size());
+        if (!file.good() || !IsPipelineCacheCompatible(initialData)) {
+            LOGGER(LOGGER::WARNING) << "Discarding incompatible pipeline cache: " << pipelineCachePath;
+            initialData.clear();
+        }
+    }
+
+    VkPipelineCacheCreateInfo cacheInfo{};
+    cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    cacheInfo.initialDataSize = initialData.size();
+    cacheInfo.pInitialData = initialData.empty() ? nullptr : initialData.data();
+    if (vkCreatePipelineCache(GetRenderDevice(), &cacheInfo, nullptr, &pipelineCache) != VK_SUCCESS) {
+        Util::ErrorPopup("Failed to create pipeline cache");
+    }
+
+    if (!initialData.empty()) {
+        LOGGER(LOGGER::INFO) << "Loaded pipeline cache: " << pipelineCachePath;
+    }
+}
+
+// drivers reject foreign data themselves, but not all of them do it gracefully
+bool VkCore::IsPipelineCacheCompatible(const std::vector<char>& data) {
+    VkPipelineCacheHeaderVersionOne header{};
+    if (data.size() < sizeof(header)) {
+        return false;
+    }
+    std::memcpy(&header, data.data(), sizeof(header));
+
+    VkPhysicalDeviceProperties properties{};
+    vkGetPhysicalDeviceProperties(GetRenderPhysicalDevice(), &properties);
+    return header.headerSize >= sizeof(header) && header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+           header.vendorID == properties.vendorID && header.deviceID == properties.deviceID &&
+           std::memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
+
+void VkCore::SavePipelineCache() {
+    size_t dataSize = 0;
+    if (vkGetPipelineCacheData(GetRenderDevice(), GetPipelineCache(), &dataSize, nullptr) != VK_SUCCESS ||
+        dataSize == 0) {
+        return;
+    }
+    std::vector<char> data(dataSize);
+    if (vkGetPipelineCacheData(GetRenderDevice(), GetPipelineCache(), &dataSize, data.data()) != VK_SUCCESS) {
+        LOGGER(LOGGER::WARNING) << "Failed to read pipeline cache data";
+        return;
+    }
+
+    // write next to the target and rename, so a crash never leaves a truncated cache behind
+    std::filesystem::path path{pipelineCachePath};
+    Util::EnsureDirExists(path.parent_path());
+    std::filesystem::path tempPath = path;
+    tempPath += ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        file.write(data.data(), dataSize);
+        if (!file.good()) {
+            LOGGER(LOGGER::WARNING) << "Failed to write pipeline cache: " << tempPath.generic_string();
+            return;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(tempPath, path, ec);
+    if (ec) {
+        LOGGER(LOGGER::WARNING) << "Failed to save pipeline cache: " << ec.message();
+    }
+}
 }    // namespace Graphics
 }    // namespace XRLib
@@ -22,6 +22,7 @@ class VkCore {
 
     void CreateVkDevice(Config& config, const std::vector<const char*>& additionalDeviceExts, bool xr);
     const VkDevice& GetRenderDevice() { return vkDevice; }
+    const VkPhysicalDeviceFeatures& GetEnabledFeatures() { return enabledFeatures; }
 
     const VkQueue& GetGraphicsQueue() { return graphicsQueue; }
     int32_t GetGraphicsQueueFamilyIndex() {
@@ -38,11 +39,28 @@ class VkCore {
     // pools
     VkCommandPool& GetCommandPool() {
         if (commandPool == VK_NULL_HANDLE) {
-            CreateCommandPool();
+            CreateCommandPool(commandPool);
         }
         return commandPool;
     }
 
+    // pools are externally synchronized, so every parallel recording worker allocates from its own. There is one
+    // set per swapchain image, so re-recording an image resets only the command buffers of that image
+    VkCommandPool& GetRecordingCommandPool(uint32_t imageIndex, uint32_t worker) {
+        if (recordingCommandPools.size() <= imageIndex) {
+            recordingCommandPools.resize(imageIndex + 1);
+        }
+        auto& pool = recordingCommandPools[imageIndex][worker];
+        if (pool == VK_NULL_HANDLE) {
+            CreateCommandPool(pool);
+        }
+        return pool;
+    }
+    // returns every command buffer allocated from the image's worker pools to the initial state
+    void ResetRecordingCommandPools(uint32_t imageIndex);
+
+    inline constexpr static uint32_t maxRecordingWorkers = 8;
+
     VkDescriptorPool& GetDescriptorPool() {
         if (descriptorPool == VK_NULL_HANDLE) {
             CreateDescriptorPool();
@@ -50,6 +68,26 @@ class VkCore {
         return descriptorPool;
     }
 
+    // update after bind pool for BindlessImages descriptor sets
+    VkDescriptorPool& GetBindlessDescriptorPool() {
+        if (bindlessDescriptorPool == VK_NULL_HANDLE) {
+            CreateBindlessDescriptorPool();
+        }
+        return bindlessDescriptorPool;
+    }
+    // slots of a bindless texture table, bounded by the device's update after bind limits
+    uint32_t GetBindlessTextureCapacity();
+
+    inline constexpr static uint32_t maxBindlessTextures = 16384;
+    inline constexpr static uint32_t maxBindlessSets = 2;
+
+    // shared by all pipelines, loaded from and saved to pipelineCachePath so warm runs skip driver compilation.
+    // Created together with the device, pipelines are built on several threads at once
+    VkPipelineCache& GetPipelineCache() { return pipelineCache; }
+    void SavePipelineCache();
+
+    inline constexpr static std::string_view pipelineCachePath = "./ShaderCache/pipeline.cache";
+
     // rendering loop
     VkSemaphore& GetRenderFinishedSemaphore() {
         if (renderFinishedSemaphore == VK_NULL_HANDLE) {
@@ -89,8 +127,11 @@ class VkCore {
         }
     }
 
-    void CreateCommandPool();
+    void CreateCommandPool(VkCommandPool& pool);
     void CreateDescriptorPool();
+    void CreateBindlessDescriptorPool();
+    void CreatePipelineCache();
+    bool IsPipelineCacheCompatible(const std::vector<char>& data);
     void CreateSyncSemaphore(VkSemaphore& semaphore);
     void CreateFence(VkFence& fence);
 
@@ -99,12 +140,16 @@ class VkCore {
     VkPhysicalDevice vkPhysicalDevice{VK_NULL_HANDLE};
     VkDevice vkDevice{VK_NULL_HANDLE};
     VkQueue graphicsQueue{VK_NULL_HANDLE};
+    VkPhysicalDeviceFeatures enabledFeatures{};
 
     VkSurfaceKHR surfaceFlat{VK_NULL_HANDLE};
 
     // pools
     VkCommandPool commandPool{VK_NULL_HANDLE};
+    std::vector<std::array<VkCommandPool, maxRecordingWorkers>> recordingCommandPools;
     VkDescriptorPool descriptorPool{VK_NULL_HANDLE};
+    VkDescriptorPool bindlessDescriptorPool{VK_NULL_HANDLE};
+    VkPipelineCache pipelineCache{VK_NULL_HANDLE};
 
     // semaphores
     VkSemaphore imageAvailableSemaphore{VK_NULL_HANDLE};
@@ -15,27 +15,62 @@ class VkGraphicsRenderpass : public IGraphicsRenderpass {
     VkGraphicsRenderpass(VkCore& core, bool multiview,
                          std::vector<std::vector<Image*>>& renderTargets, bool presentRenderTargets = true,
                          std::vector<std::unique_ptr<DescriptorSet>>&& descriptorSets = {},
-                         std::string vertexShaderPath = "", std::string fragmentShaderPath = "")
+                         std::string vertexShaderPath = "", std::string fragmentShaderPath = "",
+                         ShaderVariant variant = {})
 
-        : core{core}, multiview{multiview}, descriptorSets{std::move(descriptorSets)} {
-        Shader vertexShader{core, vertexShaderPath, Shader::VERTEX_SHADER, multiview};
-        Shader fragmentShader{core, fragmentShaderPath, Shader::FRAGMENT_SHADER, multiview};
+        : core{core},
+          descriptorSets{std::move(descriptorSets)},
+          multiview{multiview},
+          vertexShaderPath{std::move(vertexShaderPath)},
+          fragmentShaderPath{std::move(fragmentShaderPath)} {
         renderPass = std::make_unique<Renderpass>(core, renderTargets, presentRenderTargets, multiview);
-        pipeline = std::make_unique<Pipeline>(core, vertexShader, fragmentShader, *renderPass,
-                                              this->descriptorSets);
+        AddVariant(variant);
+    }
+
+    // builds another pipeline of this pass with a variant of its fragment shader and returns its index.
+    // Shader modules and the pipeline are built on a worker, the first GetPipeline of the index waits for them.
+    // All variants are created from the same descriptor sets, so the sets and push constants bound for the pass
+    // stay valid when draws switch between them
+    uint32_t AddVariant(const ShaderVariant& variant) {
+        auto vertexSpirv = Shader::CompileAsync(vertexShaderPath, Shader::VERTEX_SHADER, multiview);
+        auto fragmentSpirv =
+            Shader::CompileAsync(fragmentShaderPath, Shader::FRAGMENT_SHADER, multiview, {}, variant);
+        pipelines.emplace_back();
+        pipelineFutures.push_back(std::async(std::launch::async, [this, vertexSpirv, fragmentSpirv, variant]() {
+            Shader vertexShader{this->core, vertexSpirv, Shader::VERTEX_SHADER};
+            Shader fragmentShader{this->core, fragmentSpirv, Shader::FRAGMENT_SHADER};
+            return std::make_unique<Pipeline>(this->core, vertexShader, fragmentShader, *renderPass,
+                                              this->descriptorSets, variant);
+        }));
+        return static_cast<uint32_t>(pipelines.size() - 1);
     }
 
     Renderpass& GetRenderpass() { return *renderPass; }
-    Pipeline& GetPipeline() { return *pipeline; }
+    // variant 0 is the pipeline the pass was created with, indices of variants the pass does not have fall back
+    // to it. Not thread safe until every variant was waited for once
+    Pipeline& GetPipeline(uint32_t variant = 0) {
+        if (variant >= pipelines.size()) {
+            variant = 0;
+        }
+        if (pipelineFutures[variant].valid()) {
+            pipelines[variant] = pipelineFutures[variant].get();
+        }
+        return *pipelines[variant];
+    }
+    size_t VariantCount() const { return pipelines.size(); }
     std::vector<std::unique_ptr<DescriptorSet>>& GetDescriptorSets() { return descriptorSets; }
     bool Stereo() { return multiview; }
 
    private:
     VkCore& core;
     std::unique_ptr<Renderpass> renderPass;
-    std::unique_ptr<Pipeline> pipeline;
+    std::vector<std::unique_ptr<Pipeline>> pipelines;
     std::vector<std::unique_ptr<DescriptorSet>> descriptorSets;
     bool multiview;
+    std::string vertexShaderPath;
+    std::string fragmentShaderPath;
+    // declared last so pending builds finish before the members they use are destroyed
+    std::vector<std::future<std::unique_ptr<Pipeline>>> pipelineFutures;
 };
 }    // namespace Graphics
 }    // namespace XRLib
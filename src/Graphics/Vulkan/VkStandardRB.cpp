@@ -1,4 +1,6 @@
 #include "VkStandardRB.h"
+#include "Utils/BatchMath.h"
+#include "Utils/FrameArena.h"
 
 namespace XRLib {
 namespace Graphics {
@@ -15,31 +17,65 @@ const std::string_view VkStandardRB::defaultVertFlat = R"(
         mat4 proj;
     } vp;
 
+    struct ModelData {
+        mat4 model;
+        mat3x4 normalMatrix;
+    };
+
     layout(set = 0, binding = 1) readonly buffer ModelMatrices {
-        mat4 models[];
+        ModelData models[];
     };
 
     layout(push_constant) uniform PushConstants {
         uint modelIndex;
+        uint materialIndex;
+    };
+
+#ifdef XRLIB_QUANTIZED_VERTICES
+    struct MeshBounds {
+        vec4 min;
+        vec4 extent;
+    };
+
+    layout(set = 0, binding = 3) readonly buffer MeshBoundsBuffer {
+        MeshBounds bounds[];
     };
 
+    layout(location = 0) in vec4 inQuantizedPosition;
+    layout(location = 1) in vec2 inOctahedralNormal;
+
+    vec3 DecodeOctahedral(vec2 e) {
+        vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+        float t = max(-n.z, 0.0);
+        n.x += n.x >= 0.0 ? -t : t;
+        n.y += n.y >= 0.0 ? -t : t;
+        return normalize(n);
+    }
+#else
     layout(location = 0) in vec3 inPosition;
     layout(location = 1) in vec3 inNormal;
+#endif
     layout(location = 2) in vec2 inTexCoord;
 
     layout(location = 0) out vec3 fragNormal;
     layout(location = 1) out vec2 fragTexCoord;
     layout(location = 2) out vec3 fragWorldPos;
     layout(location = 3) out vec3 cameraPos;
+    layout(location = 4) out float fragViewDepth;
 
     void main() {
-        vec4 worldPos = models[modelIndex] * vec4(inPosition, 1.0);
+#ifdef XRLIB_QUANTIZED_VERTICES
+        vec3 inPosition = bounds[modelIndex].min.xyz + inQuantizedPosition.xyz * bounds[modelIndex].extent.xyz;
+        vec3 inNormal = DecodeOctahedral(inOctahedralNormal);
+#endif
+        vec4 worldPos = models[gl_InstanceIndex].model * vec4(inPosition, 1.0);
         gl_Position = vp.proj * vp.view * worldPos;
-        mat3 normalMatrix = transpose(inverse(mat3(models[modelIndex])));
+        mat3 normalMatrix = mat3(models[gl_InstanceIndex].normalMatrix);
         fragNormal = normalize(normalMatrix * inNormal);
         fragTexCoord = inTexCoord;
         fragWorldPos = worldPos.xyz;
         cameraPos = -vec3(vp.view[3]);
+        fragViewDepth = -(vp.view * worldPos).z;
     }
 )";
 
@@ -53,48 +89,97 @@ const std::string_view VkStandardRB::defaultVertStereo = R"(
         mat4 proj[2];
     } vp;
 
+    struct ModelData {
+        mat4 model;
+        mat3x4 normalMatrix;
+    };
+
     layout(set = 0, binding = 1) readonly buffer ModelMatrices {
-        mat4 models[];
+        ModelData models[];
     };
 
     layout(push_constant) uniform PushConstants {
         uint modelIndex;
+        uint materialIndex;
     };
 
+#ifdef XRLIB_QUANTIZED_VERTICES
+    struct MeshBounds {
+        vec4 min;
+        vec4 extent;
+    };
+
+    layout(set = 0, binding = 3) readonly buffer MeshBoundsBuffer {
+        MeshBounds bounds[];
+    };
+
+    layout(location = 0) in vec4 inQuantizedPosition;
+    layout(location = 1) in vec2 inOctahedralNormal;
+
+    vec3 DecodeOctahedral(vec2 e) {
+        vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+        float t = max(-n.z, 0.0);
+        n.x += n.x >= 0.0 ? -t : t;
+        n.y += n.y >= 0.0 ? -t : t;
+        return normalize(n);
+    }
+#else
     layout(location = 0) in vec3 inPosition;
     layout(location = 1) in vec3 inNormal;
+#endif
     layout(location = 2) in vec2 inTexCoord;
 
     layout(location = 0) out vec3 fragNormal;
     layout(location = 1) out vec2 fragTexCoord;
     layout(location= 2) out vec3 fragWorldPos;
     layout(location = 3) out vec3 cameraPos;
+    layout(location = 4) out float fragViewDepth;
 
     void main() {
-        vec4 worldPos = models[modelIndex] * vec4(inPosition, 1.0);
+#ifdef XRLIB_QUANTIZED_VERTICES
+        vec3 inPosition = bounds[modelIndex].min.xyz + inQuantizedPosition.xyz * bounds[modelIndex].extent.xyz;
+        vec3 inNormal = DecodeOctahedral(inOctahedralNormal);
+#endif
+        vec4 worldPos = models[gl_InstanceIndex].model * vec4(inPosition, 1.0);
         gl_Position = vp.proj[gl_ViewIndex] * vp.view[gl_ViewIndex] * worldPos;
-        mat3 normalMatrix = transpose(inverse(mat3(models[modelIndex])));
+        mat3 normalMatrix = mat3(models[gl_InstanceIndex].normalMatrix);
         fragNormal = normalize(normalMatrix * inNormal);
         fragTexCoord = inTexCoord;
         fragWorldPos = worldPos.xyz;
         cameraPos = -vec3(vp.view[gl_ViewIndex][3]);
+        fragViewDepth = -(vp.view[gl_ViewIndex] * worldPos).z;
     }
 )";
 
 const std::string_view VkStandardRB::defaultPhongFrag = R"(
     #version 450
     #extension GL_ARB_separate_shader_objects : enable
-    #extension GL_EXT_multiview : enable
     #extension GL_EXT_nonuniform_qualifier: enable
+    // gl_ViewIndex needs the multiview capability, which the device only enables for xr
+#ifdef XRLIB_STEREO
+    #extension GL_EXT_multiview : enable
+    #define VIEW_INDEX gl_ViewIndex
+#else
+    #define VIEW_INDEX 0
+#endif
 
     struct Light {
-        mat4 transform;
-        vec4 color;
-        float intensity;
+        vec4 positionRange;
+        vec4 colorIntensity;
     };
 
-    layout(set = 0, binding = 2) uniform sampler2D diffuseSamplers[];
-    layout(set = 0, binding = 3) uniform sampler2D normalSamplers[];
+    // material table, indexed by the materialIndex push constant
+    struct Material {
+        uvec4 textures;    // texture heap slots: diffuse, normal, metallic roughness, emissive
+        vec4 baseColorFactor;
+        vec4 emissiveFactorAlphaCutoff;
+        vec4 metallicRoughnessFactor;
+    };
+
+    layout(set = 0, binding = 2) readonly buffer Materials {
+        Material materials[];
+    };
+    layout(set = 2, binding = 0) uniform sampler2D textures[];
 
     layout(set = 1, binding = 0) uniform LightsCount{
         int lightsCount;
@@ -103,14 +188,54 @@ const std::string_view VkStandardRB::defaultPhongFrag = R"(
         Light lights[];
     };
 
+    // clustered light lists written by defaultLightClusterComp
+    layout(set = 1, binding = 2) uniform ClusterInfo {
+        mat4 views[2];
+        mat4 invProjs[2];
+        uvec4 gridSize;
+        vec4 depthAndViewport;
+        uint maxLightsPerCluster;
+    } cluster;
+
+    layout(set = 1, binding = 3) readonly buffer ClusterLightCounts {
+        uint clusterLightCounts[];
+    };
+
+    layout(set = 1, binding = 4) readonly buffer ClusterLightIndices {
+        uint clusterLightIndices[];
+    };
+
+    uint ClusterIndex(float viewDepth) {
+        float near = cluster.depthAndViewport.x;
+        float far = cluster.depthAndViewport.y;
+        uvec2 tile = uvec2(gl_FragCoord.xy / cluster.depthAndViewport.zw * vec2(cluster.gridSize.xy));
+        tile = min(tile, cluster.gridSize.xy - 1);
+        float slice = log(max(viewDepth, near) / near) / log(far / near) * float(cluster.gridSize.z);
+        uint z = min(uint(slice), cluster.gridSize.z - 1);
+        return ((VIEW_INDEX * cluster.gridSize.z + z) * cluster.gridSize.y + tile.y) * cluster.gridSize.x + tile.x;
+    }
+
+    // falls smoothly to zero at the light range, so culled lights never pop
+    float Attenuation(float distance, float range) {
+        float falloff = 1.0 / (1.0 + 0.09 * distance + 0.032 * (distance * distance));
+        float ratio = distance / max(range, 1e-4);
+        float window = clamp(1.0 - ratio * ratio * ratio * ratio, 0.0, 1.0);
+        return falloff * window * window;
+    }
+
     layout(push_constant) uniform PushConstants {
         uint modelIndex;
+        uint materialIndex;
     };
 
+    // set from ShaderVariant, feature switches are XRLIB_* defines
+    layout(constant_id = 0) const uint MAX_LIGHTS = 64;
+
     layout(location = 0) in vec3 fragNormal;
     layout(location = 1) in vec2 fragTexCoord;
     layout(location = 2) in vec3 fragWorldPos;
     layout(location = 3) in vec3 cameraPos;
+    layout(location = 4) in float fragViewDepth;
 
     layout(location = 0) out vec4 outColor;
 
@@ -131,23 +256,55 @@ const std::string_view VkStandardRB::defaultPhongFrag = R"(
 
         return (ambient + diffuse + specular) * diffuseColor * lightIntensity;
     }
+#ifdef XRLIB_NORMAL_MAP
+    // tangent frame from screen space derivatives, the vertex format carries no tangents
+    vec3 PerturbNormal(vec3 N, vec3 tangentNormal) {
+        vec3 dp1 = dFdx(fragWorldPos);
+        vec3 dp2 = dFdy(fragWorldPos);
+        vec2 duv1 = dFdx(fragTexCoord);
+        vec2 duv2 = dFdy(fragTexCoord);
+        vec3 dp2perp = cross(dp2, N);
+        vec3 dp1perp = cross(N, dp1);
+        vec3 T = dp2perp * duv1.x + dp1perp * duv2.x;
+        vec3 B = dp2perp * duv1.y + dp1perp * duv2.y;
+        float invMax = inversesqrt(max(max(dot(T, T), dot(B, B)), 1e-12));
+        return normalize(mat3(T * invMax, B * invMax, N) * tangentNormal);
+    }
+#endif
+
     void main() {
+        Material material = materials[materialIndex];
+        vec4 texColor = texture(textures[material.textures.x], fragTexCoord) * material.baseColorFactor;
+#ifdef XRLIB_ALPHA_TEST
+        if (texColor.a < material.emissiveFactorAlphaCutoff.w) {
+            discard;
+        }
+#endif
+
+#ifdef XRLIB_UNLIT
+        vec3 result = texColor.rgb;
+#else
         vec3 normal = normalize(fragNormal);
+#ifdef XRLIB_NORMAL_MAP
+        normal = PerturbNormal(normal, texture(textures[material.textures.y], fragTexCoord).rgb * 2.0 - 1.0);
+#endif
         vec3 viewDir = normalize(cameraPos - fragWorldPos);
-
-        vec4 texColor = texture(diffuseSamplers[modelIndex], fragTexCoord);
         vec3 result = vec3(0.0);
 
-        for (int i = 0; i < lightsCount; i++) {
-            vec3 lightPos = lights[i].transform[3].xyz;
+        uint clusterIndex = ClusterIndex(fragViewDepth);
+        uint clusterLightCount = min(clusterLightCounts[clusterIndex], MAX_LIGHTS);
+        for (uint c = 0; c < clusterLightCount; c++) {
+            uint i = clusterLightIndices[clusterIndex * cluster.maxLightsPerCluster + c];
+            vec3 lightPos = lights[i].positionRange.xyz;
             vec3 lightDir = normalize(lightPos - fragWorldPos);
-            vec3 lightColor = lights[i].color.rgb;
-            float lightIntensity = lights[i].intensity;
+            vec3 lightColor = lights[i].colorIntensity.rgb;
+            float lightIntensity = lights[i].colorIntensity.w;
             
             float distance = length(lightPos - fragWorldPos);
-            float attenuation = 1.0 / (1.0 + 0.09 * distance + 0.032 * (distance * distance));
+            float attenuation = Attenuation(distance, lights[i].positionRange.w);
             result += calculatePhongLighting(normal, viewDir, lightDir, lightColor, lightIntensity, texColor.rgb) * attenuation;
         }
+#endif
 
         result = pow(result, vec3(1.0/2.2));
         outColor = vec4(result, texColor.a);
@@ -158,19 +315,32 @@ const std::string_view VkStandardRB::defaultPhongFrag = R"(
 const std::string_view VkStandardRB::defaultPBRFrag = R"(
     #version 450
     #extension GL_ARB_separate_shader_objects : enable
-    #extension GL_EXT_multiview : enable
     #extension GL_EXT_nonuniform_qualifier: enable
+    // gl_ViewIndex needs the multiview capability, which the device only enables for xr
+#ifdef XRLIB_STEREO
+    #extension GL_EXT_multiview : enable
+    #define VIEW_INDEX gl_ViewIndex
+#else
+    #define VIEW_INDEX 0
+#endif
 
     struct Light {
-        mat4 transform;
-        vec4 color;
-        float intensity;
+        vec4 positionRange;
+        vec4 colorIntensity;
     };
 
-    layout(set = 0, binding = 2) uniform sampler2D diffuseSamplers[];
-    layout(set = 0, binding = 3) uniform sampler2D normalSamplers[];
-    layout(set = 0, binding = 4) uniform sampler2D metallicRoughnessSampler[];
-    layout(set = 0, binding = 5) uniform sampler2D emissiveSamplers[];
+    // material table, indexed by the materialIndex push constant
+    struct Material {
+        uvec4 textures;    // texture heap slots: diffuse, normal, metallic roughness, emissive
+        vec4 baseColorFactor;
+        vec4 emissiveFactorAlphaCutoff;
+        vec4 metallicRoughnessFactor;
+    };
+
+    layout(set = 0, binding = 2) readonly buffer Materials {
+        Material materials[];
+    };
+    layout(set = 2, binding = 0) uniform sampler2D textures[];
 
     layout(set = 1, binding = 0) uniform LightsCount {
         int lightsCount;
@@ -180,14 +350,54 @@ const std::string_view VkStandardRB::defaultPBRFrag = R"(
         Light lights[];
     };
 
+    // clustered light lists written by defaultLightClusterComp
+    layout(set = 1, binding = 2) uniform ClusterInfo {
+        mat4 views[2];
+        mat4 invProjs[2];
+        uvec4 gridSize;
+        vec4 depthAndViewport;
+        uint maxLightsPerCluster;
+    } cluster;
+
+    layout(set = 1, binding = 3) readonly buffer ClusterLightCounts {
+        uint clusterLightCounts[];
+    };
+
+    layout(set = 1, binding = 4) readonly buffer ClusterLightIndices {
+        uint clusterLightIndices[];
+    };
+
+    uint ClusterIndex(float viewDepth) {
+        float near = cluster.depthAndViewport.x;
+        float far = cluster.depthAndViewport.y;
+        uvec2 tile = uvec2(gl_FragCoord.xy / cluster.depthAndViewport.zw * vec2(cluster.gridSize.xy));
+        tile = min(tile, cluster.gridSize.xy - 1);
+        float slice = log(max(viewDepth, near) / near) / log(far / near) * float(cluster.gridSize.z);
+        uint z = min(uint(slice), cluster.gridSize.z - 1);
+        return ((VIEW_INDEX * cluster.gridSize.z + z) * cluster.gridSize.y + tile.y) * cluster.gridSize.x + tile.x;
+    }
+
+    // falls smoothly to zero at the light range, so culled lights never pop
+    float Attenuation(float distance, float range) {
+        float falloff = 1.0 / (1.0 + 0.09 * distance + 0.032 * (distance * distance));
+        float ratio = distance / max(range, 1e-4);
+        float window = clamp(1.0 - ratio * ratio * ratio * ratio, 0.0, 1.0);
+        return falloff * window * window;
+    }
+
     layout(push_constant) uniform PushConstants {
         uint modelIndex;
+        uint materialIndex;
     };
 
+    // set from ShaderVariant, feature switches are XRLIB_* defines
+    layout(constant_id = 0) const uint MAX_LIGHTS = 64;
+
     layout(location = 0) in vec3 fragNormal;
     layout(location = 1) in vec2 fragTexCoord;
     layout(location = 2) in vec3 fragWorldPos;
     layout(location = 3) in vec3 cameraPos;
+    layout(location = 4) in float fragViewDepth;
 
     layout(location = 0) out vec4 outColor;
 
@@ -220,26 +430,63 @@ const std::string_view VkStandardRB::defaultPBRFrag = R"(
         return F0 + (1.0 - F0) * pow(1.0 - cosTheta, 5.0);
     }
 
+#ifdef XRLIB_NORMAL_MAP
+    // tangent frame from screen space derivatives, the vertex format carries no tangents
+    vec3 PerturbNormal(vec3 N, vec3 tangentNormal) {
+        vec3 dp1 = dFdx(fragWorldPos);
+        vec3 dp2 = dFdy(fragWorldPos);
+        vec2 duv1 = dFdx(fragTexCoord);
+        vec2 duv2 = dFdy(fragTexCoord);
+        vec3 dp2perp = cross(dp2, N);
+        vec3 dp1perp = cross(N, dp1);
+        vec3 T = dp2perp * duv1.x + dp1perp * duv2.x;
+        vec3 B = dp2perp * duv1.y + dp1perp * duv2.y;
+        float invMax = inversesqrt(max(max(dot(T, T), dot(B, B)), 1e-12));
+        return normalize(mat3(T * invMax, B * invMax, N) * tangentNormal);
+    }
+#endif
+
     void main() {
-        int index = int(modelIndex);
-        vec3 albedo = texture(diffuseSamplers[index], fragTexCoord).rgb;
-        float ao = texture(metallicRoughnessSampler[index], fragTexCoord).r;
-        float metallic = texture(metallicRoughnessSampler[index], fragTexCoord).b;
-        float roughness = texture(metallicRoughnessSampler[index], fragTexCoord).g;
-        vec3 emissive = texture(emissiveSamplers[index], fragTexCoord).rgb;
-        vec3 normalMapSample = texture(normalSamplers[index], fragTexCoord).rgb;
-        vec3 N = normalize(fragNormal); // TODO: normal map with TBN
+        Material material = materials[materialIndex];
+        vec4 baseColor = texture(textures[material.textures.x], fragTexCoord) * material.baseColorFactor;
+#ifdef XRLIB_ALPHA_TEST
+        if (baseColor.a < material.emissiveFactorAlphaCutoff.w) {
+            discard;
+        }
+#endif
+        vec3 albedo = baseColor.rgb;
+#ifdef XRLIB_EMISSIVE
+        vec3 emissive = texture(textures[material.textures.w], fragTexCoord).rgb;
+        emissive *= material.emissiveFactorAlphaCutoff.rgb;
+#else
+        vec3 emissive = vec3(0.0);
+#endif
+
+#ifdef XRLIB_UNLIT
+        vec3 color = albedo + emissive;
+#else
+        vec3 ormSample = texture(textures[material.textures.z], fragTexCoord).rgb;
+        float ao = ormSample.r;
+        float roughness = ormSample.g * material.metallicRoughnessFactor.y;
+        float metallic = ormSample.b * material.metallicRoughnessFactor.x;
+        vec3 N = normalize(fragNormal);
+#ifdef XRLIB_NORMAL_MAP
+        N = PerturbNormal(N, texture(textures[material.textures.y], fragTexCoord).rgb * 2.0 - 1.0);
+#endif
         vec3 V = normalize(cameraPos - fragWorldPos);
         vec3 F0 = mix(vec3(0.04), albedo, metallic);
         vec3 Lo = vec3(0.0);
 
-        for (int i = 0; i < lightsCount; ++i) {
-            vec3 lightPos = vec3(lights[i].transform[3]);
+        uint clusterIndex = ClusterIndex(fragViewDepth);
+        uint clusterLightCount = min(clusterLightCounts[clusterIndex], MAX_LIGHTS);
+        for (uint c = 0; c < clusterLightCount; ++c) {
+            uint i = clusterLightIndices[clusterIndex * cluster.maxLightsPerCluster + c];
+            vec3 lightPos = lights[i].positionRange.xyz;
             vec3 L = normalize(lightPos - fragWorldPos);
             vec3 H = normalize(V + L);
             float distance = length(lightPos - fragWorldPos);
-            float attenuation = 1.0 / (1.0 + 0.09 * distance + 0.032 * (distance * distance));
-            vec3 radiance = lights[i].color.rgb * lights[i].intensity * attenuation;
+            float attenuation = Attenuation(distance, lights[i].positionRange.w);
+            vec3 radiance = lights[i].colorIntensity.rgb * lights[i].colorIntensity.w * attenuation;
             float NDF = DistributionGGX(N, H, roughness);
             float G = GeometrySmith(N, V, L, roughness);
             vec3 F = FresnelSchlick(max(dot(H, V), 0.0), F0);
@@ -255,50 +502,276 @@ const std::string_view VkStandardRB::defaultPBRFrag = R"(
 
         vec3 ambient = vec3(0.03) * albedo * ao;
         vec3 color = ambient + Lo + emissive;
+#endif
         color = color / (color + vec3(1.0));
         color = pow(color, vec3(1.0/2.2));
         outColor = vec4(color, 1.0);
     }
 )";
 
+const std::string_view VkStandardRB::defaultMeshletCullComp = R"(
+    #version 450
+    // one workgroup per meshlet, the first invocation culls and the whole group copies the indices
+    layout(local_size_x = 64) in;
+
+    struct Meshlet {
+        vec4 sphere;
+        vec4 cone;
+        uint firstIndex;
+        uint indexCount;
+        uint meshIndex;
+        uint drawIndex;
+    };
+
+    struct DrawCommand {
+        uint indexCount;
+        uint instanceCount;
+        uint firstIndex;
+        int vertexOffset;
+        uint firstInstance;
+    };
+
+    layout(set = 0, binding = 0) uniform CullData {
+        vec4 planes[12];
+        vec4 cameraPos[2];
+        uint viewCount;
+        uint meshletCount;
+    } cull;
+
+    struct ModelData {
+        mat4 model;
+        mat3x4 normalMatrix;
+    };
+
+    layout(set = 0, binding = 1) readonly buffer ModelMatrices {
+        ModelData models[];
+    };
+
+    layout(set = 0, binding = 2) readonly buffer Meshlets {
+        Meshlet meshlets[];
+    };
+
+    layout(set = 0, binding = 3) readonly buffer SourceIndices {
+        uint sourceIndices[];
+    };
+
+    layout(set = 0, binding = 4) writeonly buffer CulledIndices {
+        uint culledIndices[];
+    };
+
+    layout(set = 0, binding = 5) buffer DrawCommands {
+        DrawCommand draws[];
+    };
+
+    shared bool visible;
+    shared uint writeOffset;
+
+    void main() {
+        if (gl_WorkGroupID.x >= cull.meshletCount) {
+            return;
+        }
+        Meshlet meshlet = meshlets[gl_WorkGroupID.x];
+
+        if (gl_LocalInvocationIndex == 0) {
+            mat4 model = models[meshlet.meshIndex].model;
+            float scale = max(length(model[0].xyz), max(length(model[1].xyz), length(model[2].xyz)));
+            vec3 center = (model * vec4(meshlet.sphere.xyz, 1.0)).xyz;
+            float radius = meshlet.sphere.w * scale;
+            vec3 axis = normalize(mat3(model) * meshlet.cone.xyz);
+
+            // visible if any view sees it inside the frustum and not from behind
+            bool anyView = false;
+            for (uint v = 0; v < cull.viewCount; ++v) {
+                bool inFrustum = true;
+                for (uint p = 0; p < 6; ++p) {
+                    vec4 plane = cull.planes[v * 6 + p];
+                    inFrustum = inFrustum && dot(plane.xyz, center) + plane.w > -radius;
+                }
+                vec3 toCenter = center - cull.cameraPos[v].xyz;
+                bool backfacing = dot(toCenter, axis) >= meshlet.cone.w * length(toCenter) + radius;
+                anyView = anyView || (inFrustum && !backfacing);
+            }
+
+            visible = anyView;
+            if (anyView) {
+                writeOffset = draws[meshlet.drawIndex].firstIndex +
+                              atomicAdd(draws[meshlet.drawIndex].indexCount, meshlet.indexCount);
+            }
+        }
+        barrier();
+
+        if (!visible) {
+            return;
+        }
+        for (uint i = gl_LocalInvocationIndex; i < meshlet.indexCount; i += gl_WorkGroupSize.x) {
+            culledIndices[writeOffset + i] = sourceIndices[meshlet.firstIndex + i];
+        }
+    }
+)";
+
+const std::string_view VkStandardRB::defaultLightClusterComp = R"(
+    #version 450
+    // one invocation per cluster, workgroup y is the view. Lights are staged through shared memory in batches
+    layout(local_size_x = 64) in;
+
+    struct Light {
+        vec4 positionRange;
+        vec4 colorIntensity;
+    };
+
+    layout(set = 0, binding = 0) uniform ClusterInfo {
+        mat4 views[2];
+        mat4 invProjs[2];
+        uvec4 gridSize;
+        vec4 depthAndViewport;
+        uint maxLightsPerCluster;
+    } cluster;
+
+    layout(set = 0, binding = 1) uniform LightsCount {
+        int lightsCount;
+    };
+
+    layout(set = 0, binding = 2) readonly buffer Lights {
+        Light lights[];
+    };
+
+    layout(set = 0, binding = 3) writeonly buffer ClusterLightCounts {
+        uint clusterLightCounts[];
+    };
+
+    layout(set = 0, binding = 4) writeonly buffer ClusterLightIndices {
+        uint clusterLightIndices[];
+    };
+
+    shared vec4 batchLights[gl_WorkGroupSize.x];
+
+    // point on the ray through ndc at the given view space depth
+    vec3 ViewPosition(uint view, vec2 ndc, float depth) {
+        vec4 p = cluster.invProjs[view] * vec4(ndc, 1.0, 1.0);
+        vec3 dir = p.xyz / p.w;
+        return dir * (depth / -dir.z);
+    }
+
+    void main() {
+        uint view = gl_WorkGroupID.y;
+        uvec3 grid = cluster.gridSize.xyz;
+        uint clustersPerView = grid.x * grid.y * grid.z;
+        uint local = gl_GlobalInvocationID.x;
+        bool active = local < clustersPerView;
+
+        uvec3 id = uvec3(local % grid.x, (local / grid.x) % grid.y, local / (grid.x * grid.y));
+        float near = cluster.depthAndViewport.x;
+        float far = cluster.depthAndViewport.y;
+        float sliceNear = near * pow(far / near, float(id.z) / float(grid.z));
+        float sliceFar = near * pow(far / near, float(id.z + 1) / float(grid.z));
+        vec2 ndcMin = vec2(id.xy) / vec2(grid.xy) * 2.0 - 1.0;
+        vec2 ndcMax = vec2(id.xy + 1) / vec2(grid.xy) * 2.0 - 1.0;
+
+        vec3 aabbMin = vec3(1e30);
+        vec3 aabbMax = vec3(-1e30);
+        for (uint corner = 0; corner < 8; ++corner) {
+            vec2 ndc = vec2((corner & 1) == 0 ? ndcMin.x : ndcMax.x, (corner & 2) == 0 ? ndcMin.y : ndcMax.y);
+            vec3 p = ViewPosition(view, ndc, (corner & 4) == 0 ? sliceNear : sliceFar);
+            aabbMin = min(aabbMin, p);
+            aabbMax = max(aabbMax, p);
+        }
+
+        uint count = 0;
+        uint clusterIndex = view * clustersPerView + local;
+        for (uint batch = 0; batch < uint(lightsCount); batch += gl_WorkGroupSize.x) {
+            uint lightIndex = batch + gl_LocalInvocationIndex;
+            if (lightIndex < uint(lightsCount)) {
+                vec4 position = cluster.views[view] * vec4(lights[lightIndex].positionRange.xyz, 1.0);
+                batchLights[gl_LocalInvocationIndex] = vec4(position.xyz, lights[lightIndex].positionRange.w);
+            }
+            barrier();
+
+            uint batchCount = min(gl_WorkGroupSize.x, uint(lightsCount) - batch);
+            for (uint j = 0; active && j < batchCount && count < cluster.maxLightsPerCluster; ++j) {
+                vec4 light = batchLights[j];
+                vec3 closest = clamp(light.xyz, aabbMin, aabbMax);
+                vec3 delta = closest - light.xyz;
+                if (dot(delta, delta) <= light.w * light.w) {
+                    clusterLightIndices[clusterIndex * cluster.maxLightsPerCluster + count] = batch + j;
+                    ++count;
+                }
+            }
+            barrier();
+        }
+
+        if (active) {
+            clusterLightCounts[clusterIndex] = count;
+        }
+    }
+)";
+
 ////////////////////////////////////////////////////
 /// Default Buffers creation
 ////////////////////////////////////////////////////
-std::shared_ptr<Buffer> CreateModelPositionBuffer(VkCore& core, Scene& scene) {
-    std::vector<glm::mat4> modelPositions(scene.Meshes().size());
-    for (int i = 0; i < modelPositions.size(); ++i) {
-        modelPositions[i] = scene.Meshes()[i]->GetGlobalTransform().GetMatrix();
+// layout shared with the ModelData struct of the default shaders, the normal matrix is padded to three vec4 columns
+struct ModelData {
+    glm::mat4 model;
+    glm::mat3x4 normalMatrix;
+};
+static_assert(sizeof(ModelData) == 112);
+
+ModelData MakeModelData(const glm::mat4& model) {
+    ModelData data{model};
+    BatchMath::InverseTranspose(&model, &data.normalMatrix, 1);
+    return data;
+}
+
+// normal matrices of a whole range in batches, then interleaved with the models
+void WriteModelData(const glm::mat4* models, size_t count, ModelData* out) {
+    std::array<glm::mat3x4, 256> normalMatrices;
+    for (size_t first = 0; first < count; first += normalMatrices.size()) {
+        const size_t batch = std::min(normalMatrices.size(), count - first);
+        BatchMath::InverseTranspose(models + first, normalMatrices.data(), batch);
+        for (size_t i = 0; i < batch; ++i) {
+            out[first + i] = {models[first + i], normalMatrices[i]};
+        }
     }
+}
 
-    if (modelPositions.empty()) {
-        Transform tempTransform;
-        modelPositions.push_back(tempTransform.GetMatrix());
+// model data of all meshes, followed by the model data of every instance group.
+// The draw's firstInstance points into this buffer, so the vertex shaders index it with gl_InstanceIndex.
+// Normal matrices are computed on the cpu only when a transform changes instead of per vertex in the shaders
+std::shared_ptr<Buffer> CreateModelPositionBuffer(VkCore& core, Scene& scene, std::vector<glm::mat4>& worldMatrices) {
+    size_t instanceCount = 0;
+    for (const auto& instanceGroup : scene.InstanceGroups()) {
+        instanceCount += instanceGroup->Size();
     }
 
-    auto modelPositionsBuffer =
-        std::make_shared<Buffer>(core, sizeof(glm::mat4) * modelPositions.size(),
-                                 VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-                                 static_cast<void*>(modelPositions.data()), false);
+    std::vector<ModelData> modelData(scene.Meshes().size() + instanceCount);
+    worldMatrices.resize(scene.Meshes().size());
+    for (int i = 0; i < scene.Meshes().size(); ++i) {
+        worldMatrices[i] = scene.Meshes()[i]->GetGlobalTransform().GetMatrix();
+    }
+    WriteModelData(worldMatrices.data(), worldMatrices.size(), modelData.data());
+
+    size_t instanceOffset = scene.Meshes().size();
+    for (const auto& instanceGroup : scene.InstanceGroups()) {
+        WriteModelData(instanceGroup->GetTransforms().data(), instanceGroup->Size(),
+                       modelData.data() + instanceOffset);
+        instanceGroup->ClearDirty();
+        instanceOffset += instanceGroup->Size();
+    }
 
-    EventSystem::Callback<> modelPositionBufferCallback = [&scene, &buffer = *modelPositionsBuffer]() {
-        std::vector<glm::mat4> modelPositions(scene.Meshes().size());
-        for (int i = 0; i < modelPositions.size(); ++i) {
-            modelPositions[i] = scene.Meshes()[i]->GetGlobalTransform().GetMatrix();
-        }
-        buffer.UpdateBuffer(sizeof(glm::mat4) * modelPositions.size(), static_cast<void*>(modelPositions.data()));
-    };
+    if (modelData.empty()) {
+        Transform tempTransform;
+        modelData.push_back(MakeModelData(tempTransform.GetMatrix()));
+    }
 
-    EventSystem::RegisterListener(Events::XRLIB_EVENT_APPLICATION_PRE_RENDERING, modelPositionBufferCallback);
-    return modelPositionsBuffer;
+    // host visible, so per frame updates are plain writes into the mapped memory, see ApplySnapshot
+    return std::make_shared<Buffer>(core, sizeof(ModelData) * modelData.size(),
+                                    VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                    static_cast<void*>(modelData.data()), false);
 }
 
-std::shared_ptr<Buffer> CreateViewProjectionBuffer(VkCore& core, Primitives::ViewProjectionStereo& viewProj) {
-    auto viewProjBuffer = std::make_shared<Buffer>(
-        core, sizeof(viewProj), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-        static_cast<void*>(&viewProj), false);
-
-    EventSystem::Callback<std::vector<glm::mat4>, std::vector<glm::mat4>> bufferCamUpdateCallback =
-        [&buffer = *viewProjBuffer, &viewProj](std::vector<glm::mat4> views, std::vector<glm::mat4> projs) {
+// head tracking only updates the cpu copy, it is written to the frame's uniform region right before recording
+void RegisterHeadMovementListener(Primitives::ViewProjectionStereo& viewProj) {
+    EventSystem::Callback<std::vector<glm::mat4>, std::vector<glm::mat4>> camUpdateCallback =
+        [&viewProj](std::vector<glm::mat4> views, std::vector<glm::mat4> projs) {
             if (views.size() != 2 || projs.size() != 2) {
                 Util::ErrorPopup("Unknown view size, please use custom shader");
                 return;
@@ -308,69 +781,156 @@ std::shared_ptr<Buffer> CreateViewProjectionBuffer(VkCore& core, Primitives::Vie
                 viewProj.views[i] = views[i];
                 viewProj.projs[i] = projs[i];
             }
-
-            buffer.UpdateBuffer(sizeof(Primitives::ViewProjectionStereo), static_cast<void*>(&viewProj));
         };
 
-    EventSystem::RegisterListener(Events::XRLIB_EVENT_HEAD_MOVEMENT, bufferCamUpdateCallback);
-    return viewProjBuffer;
+    EventSystem::RegisterListener(Events::XRLIB_EVENT_HEAD_MOVEMENT, camUpdateCallback);
 }
 
-std::shared_ptr<Buffer> CreateViewProjectionBuffer(VkCore& core, Scene& scene, Primitives::ViewProjection& viewProj) {
-    auto viewProjBuffer = std::make_shared<Buffer>(
-        core, sizeof(viewProj), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-        static_cast<void*>(&viewProj), false);
-    EventSystem::Callback<int> bufferOnKeyShouldUpdateCallback = [&scene, &viewProj,
-                                                                  &buffer1 = *viewProjBuffer](int keyCode) {
-        viewProj.view = scene.MainCamera()->CameraView();
-        buffer1.UpdateBuffer(sizeof(Primitives::ViewProjection), static_cast<void*>(&viewProj));
+// uploads the textures of every material into the heap and packs the materials into one table.
+// Meshes sharing a material share its entry, identical textures, such as the 1x1 defaults, share one slot
+std::shared_ptr<Buffer> CreateMaterialBuffer(VkCore& core, Scene& scene, TextureHeap& textureHeap,
+                                             std::vector<uint32_t>& meshMaterialIndices,
+                                             std::unordered_map<const Material*, uint32_t>& materialIndices) {
+    std::unordered_map<std::string, uint32_t> uploadedSlots;
+    auto upload = [&](const TextureData& texture) {
+        auto hash = Util::Hash128({reinterpret_cast<const char*>(texture.textureData.data()),
+                                   texture.textureData.size()});
+        std::string key = FORMAT_STRING("{:x}{:x}_{}x{}x{}", hash[0], hash[1], texture.textureWidth,
+                                        texture.textureHeight, texture.textureChannels);
+        auto it = uploadedSlots.find(key);
+        if (it != uploadedSlots.end()) {
+            return it->second;
+        }
+        uint32_t slot = textureHeap.Add(std::make_shared<Image>(core, texture.textureData, texture.textureWidth,
+                                                                texture.textureHeight, texture.textureChannels,
+                                                                VK_FORMAT_R8G8B8A8_SRGB));
+        uploadedSlots.emplace(std::move(key), slot);
+        return slot;
     };
 
-    EventSystem::RegisterListener(Events::XRLIB_EVENT_KEY_PRESSED, bufferOnKeyShouldUpdateCallback);
+    materialIndices.clear();
+    std::vector<Primitives::MaterialData> materials;
+    meshMaterialIndices.resize(scene.Meshes().size());
+    for (size_t i = 0; i < scene.Meshes().size(); ++i) {
+        const Material& material = scene.Meshes()[i]->GetMaterial();
+        auto [it, inserted] = materialIndices.try_emplace(&material, static_cast<uint32_t>(materials.size()));
+        meshMaterialIndices[i] = it->second;
+        if (!inserted) {
+            continue;
+        }
 
-    EventSystem::Callback<double, double> bufferOnMouseShouldUpdateCallback =
-        [&scene, &viewProj, &buffer2 = *viewProjBuffer](double deltaX, double deltaY) {
-            viewProj.view = scene.MainCamera()->CameraView();
-            buffer2.UpdateBuffer(sizeof(Primitives::ViewProjection), static_cast<void*>(&viewProj));
-        };
+        auto& data = materials.emplace_back();
+        data.textures = {upload(material.Diffuse), upload(material.Normal), upload(material.MetallicRoughness),
+                         upload(material.Emissive)};
+        data.baseColorFactor = material.baseColorFactor;
+        data.emissiveFactorAlphaCutoff = glm::vec4(material.emissiveFactor, material.alphaCutoff);
+        data.metallicRoughnessFactor = {material.metallicFactor, material.roughnessFactor, 0.0f, 0.0f};
+    }
+    LOGGER(LOGGER::INFO) << "Uploaded " << materials.size() << " materials with " << uploadedSlots.size()
+                         << " unique textures for " << scene.Meshes().size() << " meshes";
 
-    EventSystem::RegisterListener(Events::XRLIB_EVENT_MOUSE_RIGHT_MOVEMENT_EVENT, bufferOnMouseShouldUpdateCallback);
-    return viewProjBuffer;
+    if (materials.empty()) {
+        materials.emplace_back();
+    }
+    return std::make_shared<Buffer>(core, sizeof(Primitives::MaterialData) * materials.size(),
+                                    VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                    static_cast<void*>(materials.data()), true);
 }
 
-std::vector<std::shared_ptr<Image>>
-CreateTextures(VkCore& core, Scene& scene, const std::function<const Mesh::TextureData&(const Mesh&)>& getTexture) {
-    std::vector<std::shared_ptr<Image>> textures(scene.Meshes().size());
-
-    for (size_t i = 0; i < textures.size(); ++i) {
+// quantization bounds of every mesh, only read by the shaders when XRLIB_QUANTIZED_VERTICES is set
+std::shared_ptr<Buffer> CreateMeshBoundsBuffer(VkCore& core, Scene& scene) {
+    std::vector<Primitives::MeshBounds> meshBounds(std::max<size_t>(scene.Meshes().size(), 1));
+    for (size_t i = 0; i < scene.Meshes().size(); ++i) {
         const auto& mesh = *scene.Meshes()[i];
-        const auto& texture = getTexture(mesh);
+        meshBounds[i].min = glm::vec4(mesh.GetBoundsMin(), 0.0f);
+        meshBounds[i].extent = glm::vec4(mesh.GetBoundsMax() - mesh.GetBoundsMin(), 0.0f);
+    }
+
+    return std::make_shared<Buffer>(core, sizeof(Primitives::MeshBounds) * meshBounds.size(),
+                                    VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                    static_cast<void*>(meshBounds.data()), false);
+}
 
-        textures[i] = std::make_shared<Image>(core, texture.textureData, texture.textureWidth, texture.textureHeight,
-                                              texture.textureChannels, VK_FORMAT_R8G8B8A8_SRGB);
+// layouts shared with defaultMeshletCullComp
+struct GpuMeshlet {
+    glm::vec4 sphere;
+    glm::vec4 cone;
+    uint32_t firstIndex;
+    uint32_t indexCount;
+    uint32_t meshIndex;
+    uint32_t drawIndex;
+};
+
+struct MeshletCullData {
+    glm::vec4 planes[12];
+    glm::vec4 cameraPos[2];
+    uint32_t viewCount;
+    uint32_t meshletCount;
+};
+
+// layout shared with defaultLightClusterComp and the default fragment shaders
+struct ClusterInfo {
+    glm::mat4 views[2];
+    glm::mat4 invProjs[2];
+    glm::uvec4 gridSize;
+    glm::vec4 depthAndViewport;
+    uint32_t maxLightsPerCluster;
+};
+
+// view space depth of the planes a projection maps to 0 and 1 depth, so it works for projections built for
+// either depth convention, the visible range is what ends up inside 0 to 1 after the projection
+glm::vec2 ProjectionDepthRange(const glm::mat4& invProj, float maxDepthRatio) {
+    auto viewDepth = [&invProj](float depth) {
+        glm::vec4 position = invProj * glm::vec4(0.0f, 0.0f, depth, 1.0f);
+        return -position.z / position.w;
+    };
+    float near = viewDepth(0.0f);
+    float far = viewDepth(1.0f);
+    if (!std::isfinite(near) || near <= 0.0f) {
+        near = 1e-3f;
+    }
+    if (!std::isfinite(far) || far <= near || far > near * maxDepthRatio) {
+        far = near * maxDepthRatio;
     }
+    return {near, far};
+}
 
-    return textures;
+// frustum planes of a view projection matrix with 0 to 1 depth, pointing inwards
+void ExtractFrustumPlanes(const glm::mat4& viewProjection, glm::vec4* planes) {
+    glm::mat4 rows = glm::transpose(viewProjection);
+    planes[0] = rows[3] + rows[0];
+    planes[1] = rows[3] - rows[0];
+    planes[2] = rows[3] + rows[1];
+    planes[3] = rows[3] - rows[1];
+    planes[4] = rows[2];
+    planes[5] = rows[3] - rows[2];
+    for (int i = 0; i < 6; ++i) {
+        planes[i] /= glm::length(glm::vec3(planes[i]));
+    }
 }
 
-std::pair<std::shared_ptr<Buffer>, std::shared_ptr<Buffer>> CreateLightBuffer(VkCore& core, Scene& scene) {
-    VkBufferUsageFlags usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+static_assert(sizeof(Primitives::PointLightData) == 32);
 
-    struct PointLightData {
-        Transform transform;
-        glm::vec4 color;
-        float intensity;
-    };
+Primitives::PointLightData PackPointLight(PointLight& light) {
+    return {glm::vec4(glm::vec3(light.GetGlobalTransform().GetMatrix()[3]), light.GetRange()),
+            glm::vec4(glm::vec3(light.GetColor()), light.GetIntensity())};
+}
 
-    std::vector<PointLightData> pointLightDataBuffer(scene.PointLights().size());
-    for (size_t i = 0; i < pointLightDataBuffer.size(); ++i) {
-        pointLightDataBuffer[i].transform = scene.PointLights()[i]->GetGlobalTransform();
-        pointLightDataBuffer[i].color = scene.PointLights()[i]->GetColor();
-        pointLightDataBuffer[i].intensity = scene.PointLights()[i]->GetIntensity();
+// light count is fixed once prepared, the lights themselves are re-packed every frame and only changed entries
+// are written to the mapped buffer. The uploaded lights are kept for that comparison
+std::pair<std::shared_ptr<Buffer>, std::shared_ptr<Buffer>>
+CreateLightBuffer(VkCore& core, Scene& scene, std::vector<Primitives::PointLightData>& pointLightDataBuffer) {
+    VkBufferUsageFlags usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+
+    pointLightDataBuffer.resize(std::max<size_t>(scene.PointLights().size(), 1));
+    for (size_t i = 0; i < scene.PointLights().size(); ++i) {
+        pointLightDataBuffer[i] = PackPointLight(*scene.PointLights()[i]);
     }
 
-    auto lightsBuffer = std::make_unique<Buffer>(core, sizeof(PointLightData) * scene.PointLights().size(), usage,
-                                                 static_cast<void*>(pointLightDataBuffer.data()), false);
+    auto lightsBuffer =
+        std::make_shared<Buffer>(core, sizeof(Primitives::PointLightData) * pointLightDataBuffer.size(), usage,
+                                 static_cast<void*>(pointLightDataBuffer.data()), false);
+
     usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
     int lightsCount = scene.PointLights().size();
     auto lightsCountBuffer =
@@ -383,32 +943,66 @@ std::pair<std::shared_ptr<Buffer>, std::shared_ptr<Buffer>> CreateLightBuffer(Vk
 // Default DescriptorLayout and Renderpasses binding
 ////////////////////////////////////////////////////
 void VkStandardRB::PrepareDefaultRenderPasses(std::vector<std::vector<Image*>>& swapchainImages,
-                                              std::shared_ptr<Buffer> viewProjBuffer) {
-    auto modelPositionsBuffer = std::move(CreateModelPositionBuffer(core, scene));
+                                              DynamicUniform viewProjUniform) {
+    auto modelPositionsBuffer = std::move(CreateModelPositionBuffer(core, scene, meshWorldMatrices));
+    modelBuffer = modelPositionsBuffer;
+    preparedInstanceCount = 0;
+    for (const auto& instanceGroup : scene.InstanceGroups()) {
+        preparedInstanceCount += instanceGroup->Size();
+    }
+    PrepareMeshletCulling(modelPositionsBuffer);
+
+    // bindless texture table, set 2 of the default pass
+    auto textureSet = std::make_unique<DescriptorSet>(core, BindlessImages{core.GetBindlessTextureCapacity()});
+    textureHeap = std::make_unique<TextureHeap>(*textureSet, 0, core.GetBindlessTextureCapacity());
+    auto materialsBuffer =
+        std::move(CreateMaterialBuffer(core, scene, *textureHeap, meshMaterialIndices, materialIndices));
 
-    auto diffuseTextures = std::move(
-        CreateTextures(core, scene, [](const Mesh& mesh) -> const Mesh::TextureData& { return mesh.Diffuse; }));
-    auto normalTextures = std::move(
-        CreateTextures(core, scene, [](const Mesh& mesh) -> const Mesh::TextureData& { return mesh.Normal; }));
-    auto metallicRoughness = std::move(CreateTextures(
-        core, scene, [](const Mesh& mesh) -> const Mesh::TextureData& { return mesh.MetallicRoughness; }));
-    auto emissiveTextures = std::move(
-        CreateTextures(core, scene, [](const Mesh& mesh) -> const Mesh::TextureData& { return mesh.Emissive; }));
+    auto meshBoundsBuffer = std::move(CreateMeshBoundsBuffer(core, scene));
 
-    auto [lightsCountBuffer, lightsBuffer] = std::move(CreateLightBuffer(core, scene));
+    auto [lightsCountBuffer, lightsBuffer] = std::move(CreateLightBuffer(core, scene, uploadedPointLights));
+    pointLightBuffer = lightsBuffer;
+    preparedPointLights = scene.PointLights().size();
 
     std::vector<std::unique_ptr<DescriptorSet>> descriptorSets;
-    auto descriptorSet = std::make_unique<DescriptorSet>(core, viewProjBuffer, modelPositionsBuffer, diffuseTextures,
-                                                         normalTextures, metallicRoughness, emissiveTextures);
-    descriptorSet->AllocatePushConstant(sizeof(uint32_t));
+    auto descriptorSet = std::make_unique<DescriptorSet>(core, viewProjUniform, modelPositionsBuffer,
+                                                         materialsBuffer, meshBoundsBuffer);
+    descriptorSet->AllocatePushConstant(sizeof(Primitives::DrawPushConstants));
     descriptorSets.push_back(std::move(descriptorSet));
 
-    auto descriptorSet2 = std::make_unique<DescriptorSet>(core, lightsCountBuffer, lightsBuffer);
-    descriptorSet2->AllocatePushConstant(sizeof(uint32_t));
+    auto [clusterInfoBuffer, clusterLightCountsBuffer, clusterLightIndicesBuffer] =
+        std::move(PrepareLightClustering(lightsCountBuffer, lightsBuffer));
+
+    auto descriptorSet2 = std::make_unique<DescriptorSet>(core, lightsCountBuffer, lightsBuffer, clusterInfoBuffer,
+                                                          clusterLightCountsBuffer, clusterLightIndicesBuffer);
+    descriptorSet2->AllocatePushConstant(sizeof(Primitives::DrawPushConstants));
     descriptorSets.push_back(std::move(descriptorSet2));
+    descriptorSets.push_back(std::move(textureSet));
+
+    // one pipeline per distinct variant of the materials in the table, in table order
+    std::vector<const Material*> tableMaterials(materialIndices.size());
+    for (const auto& [material, index] : materialIndices) {
+        tableMaterials[index] = material;
+    }
+    std::vector<ShaderVariant> variants;
+    materialVariants.clear();
+    for (const Material* material : tableMaterials) {
+        ShaderVariant variant = MaterialShaderVariant(*material);
+        auto it = std::find(variants.begin(), variants.end(), variant);
+        materialVariants.push_back(static_cast<uint32_t>(it - variants.begin()));
+        if (it == variants.end()) {
+            variants.push_back(variant);
+        }
+    }
+    if (variants.empty()) {
+        variants.push_back(MaterialShaderVariant(Material{}));
+    }
 
-    std::unique_ptr<IGraphicsRenderpass> graphicsRenderPass =
-        std::make_unique<VkGraphicsRenderpass>(core, stereo, swapchainImages, true, std::move(descriptorSets));
+    auto graphicsRenderPass = std::make_unique<VkGraphicsRenderpass>(core, stereo, swapchainImages, true,
+                                                                     std::move(descriptorSets), "", "", variants[0]);
+    for (size_t i = 1; i < variants.size(); ++i) {
+        graphicsRenderPass->AddVariant(variants[i]);
+    }
     renderPasses->push_back(std::move(graphicsRenderPass));
 }
 
@@ -427,10 +1021,22 @@ void VkStandardRB::InitVerticesIndicesBuffers() {
             continue;
         }
 
-        void* verticesData = static_cast<void*>(mesh.GetVerticies().data());
+        std::vector<Primitives::RenderVertex> renderVertices;
+        if constexpr (std::is_same_v<Primitives::RenderVertex, Primitives::QuantizedVertex>) {
+            const glm::vec3 boundsExtent = mesh.GetBoundsMax() - mesh.GetBoundsMin();
+            renderVertices.reserve(mesh.GetVerticies().size());
+            for (const auto& vertex : mesh.GetVerticies()) {
+                renderVertices.push_back(
+                    Primitives::QuantizedVertex::FromVertex(vertex, mesh.GetBoundsMin(), boundsExtent));
+            }
+        } else {
+            renderVertices = mesh.GetVerticies();
+        }
+
+        void* verticesData = static_cast<void*>(renderVertices.data());
         void* indicesData = static_cast<void*>(mesh.GetIndices().data());
         vertexBuffers[i] =
-            std::make_unique<Buffer>(core, sizeof(mesh.GetVerticies()[0]) * mesh.GetVerticies().size(),
+            std::make_unique<Buffer>(core, sizeof(Primitives::RenderVertex) * renderVertices.size(),
                                      VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, verticesData,
                                      true, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
 
@@ -440,17 +1046,282 @@ void VkStandardRB::InitVerticesIndicesBuffers() {
     }
 }
 
+void VkStandardRB::PrepareMeshletCulling(std::shared_ptr<Buffer> modelPositionsBuffer) {
+    meshletCulling.drawIndices.assign(scene.Meshes().size(), -1);
+
+    // meshlets of every mesh share one source and one culled index buffer, each mesh owns a region of both
+    std::vector<GpuMeshlet> meshlets;
+    std::vector<uint32_t> sourceIndices;
+    std::vector<VkDrawIndexedIndirectCommand> drawCommands;
+    for (uint32_t i = 0; i < scene.Meshes().size(); ++i) {
+        auto& mesh = *scene.Meshes()[i];
+        if (mesh.GetMeshlets().empty() || vertexBuffers.empty() || vertexBuffers[i] == nullptr) {
+            continue;
+        }
+
+        const Mesh::LOD fullLOD = mesh.GetFullLOD();
+        const uint32_t regionBase = static_cast<uint32_t>(sourceIndices.size());
+        const uint32_t drawIndex = static_cast<uint32_t>(drawCommands.size());
+        sourceIndices.insert(sourceIndices.end(), mesh.GetIndices().begin() + fullLOD.firstIndex,
+                             mesh.GetIndices().begin() + fullLOD.firstIndex + fullLOD.indexCount);
+
+        for (const auto& meshlet : mesh.GetMeshlets()) {
+            meshlets.push_back({glm::vec4(meshlet.center, meshlet.radius),
+                                glm::vec4(meshlet.coneAxis, meshlet.coneCutoff),
+                                regionBase + meshlet.firstIndex - fullLOD.firstIndex, meshlet.indexCount, i,
+                                drawIndex});
+        }
+
+        // index count is reset to 0 every frame and accumulated by the cull pass
+        drawCommands.push_back({0, 1, regionBase, 0, i});
+        meshletCulling.drawIndices[i] = static_cast<int32_t>(drawIndex);
+    }
+
+    if (meshlets.empty()) {
+        return;
+    }
+
+    if (!core.GetEnabledFeatures().drawIndirectFirstInstance) {
+        LOGGER(LOGGER::WARNING) << "drawIndirectFirstInstance is not supported, meshlet culling disabled";
+        meshletCulling.drawIndices.assign(scene.Meshes().size(), -1);
+        return;
+    }
+
+    meshletCulling.meshletCount = static_cast<uint32_t>(meshlets.size());
+
+    MeshletCullData cullData{};
+    meshletCulling.cullDataBuffer =
+        std::make_shared<Buffer>(core, sizeof(MeshletCullData), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+                                 static_cast<void*>(&cullData), false);
+
+    auto meshletBuffer = std::make_shared<Buffer>(
+        core, sizeof(GpuMeshlet) * meshlets.size(),
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, static_cast<void*>(meshlets.data()),
+        true, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    auto sourceIndexBuffer = std::make_shared<Buffer>(
+        core, sizeof(uint32_t) * sourceIndices.size(),
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, static_cast<void*>(sourceIndices.data()),
+        true, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    meshletCulling.culledIndexBuffer = std::make_shared<Buffer>(
+        core, sizeof(uint32_t) * sourceIndices.size(),
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    const VkDeviceSize drawCommandsSize = sizeof(VkDrawIndexedIndirectCommand) * drawCommands.size();
+    meshletCulling.drawCommandBuffer = std::make_shared<Buffer>(
+        core, drawCommandsSize,
+        VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        static_cast<void*>(drawCommands.data()), true, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    meshletCulling.drawCommandResetBuffer = std::make_unique<Buffer>(
+        core, drawCommandsSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        static_cast<void*>(drawCommands.data()), true, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    std::vector<DescriptorLayoutElement> layout{
+        {meshletCulling.cullDataBuffer, VK_SHADER_STAGE_COMPUTE_BIT},
+        {modelPositionsBuffer, VK_SHADER_STAGE_COMPUTE_BIT},
+        {meshletBuffer, VK_SHADER_STAGE_COMPUTE_BIT},
+        {sourceIndexBuffer, VK_SHADER_STAGE_COMPUTE_BIT},
+        {meshletCulling.culledIndexBuffer, VK_SHADER_STAGE_COMPUTE_BIT},
+        {meshletCulling.drawCommandBuffer, VK_SHADER_STAGE_COMPUTE_BIT},
+    };
+    meshletCulling.descriptorSets.push_back(std::make_unique<DescriptorSet>(core, layout));
+
+    Shader cullShader{core, "", Shader::COMPUTE_SHADER, stereo, defaultMeshletCullComp};
+    meshletCulling.pipeline = std::make_unique<Pipeline>(core, cullShader, meshletCulling.descriptorSets);
+}
+
+std::tuple<std::shared_ptr<Buffer>, std::shared_ptr<Buffer>, std::shared_ptr<Buffer>>
+VkStandardRB::PrepareLightClustering(std::shared_ptr<Buffer> lightsCountBuffer, std::shared_ptr<Buffer> lightsBuffer) {
+    const uint32_t viewCount = stereo ? 2 : 1;
+    const uint32_t clusterCount = clusterGridX * clusterGridY * clusterGridZ * viewCount;
+
+    ClusterInfo clusterInfo{};
+    clusterInfo.gridSize = {clusterGridX, clusterGridY, clusterGridZ, viewCount};
+    clusterInfo.maxLightsPerCluster = maxLightsPerCluster;
+    lightClustering.clusterInfoBuffer =
+        std::make_shared<Buffer>(core, sizeof(ClusterInfo), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+                                 static_cast<void*>(&clusterInfo), false);
+
+    lightClustering.clusterLightCountsBuffer = std::make_shared<Buffer>(
+        core, sizeof(uint32_t) * clusterCount, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    lightClustering.clusterLightIndicesBuffer =
+        std::make_shared<Buffer>(core, sizeof(uint32_t) * clusterCount * maxLightsPerCluster,
+                                 VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    std::vector<DescriptorLayoutElement> layout{
+        {lightClustering.clusterInfoBuffer, VK_SHADER_STAGE_COMPUTE_BIT},
+        {lightsCountBuffer, VK_SHADER_STAGE_COMPUTE_BIT},
+        {lightsBuffer, VK_SHADER_STAGE_COMPUTE_BIT},
+        {lightClustering.clusterLightCountsBuffer, VK_SHADER_STAGE_COMPUTE_BIT},
+        {lightClustering.clusterLightIndicesBuffer, VK_SHADER_STAGE_COMPUTE_BIT},
+    };
+    lightClustering.descriptorSets.push_back(std::make_unique<DescriptorSet>(core, layout));
+
+    Shader clusterShader{core, "", Shader::COMPUTE_SHADER, stereo, defaultLightClusterComp};
+    lightClustering.pipeline = std::make_unique<Pipeline>(core, clusterShader, lightClustering.descriptorSets);
+
+    return {lightClustering.clusterInfoBuffer, lightClustering.clusterLightCountsBuffer,
+            lightClustering.clusterLightIndicesBuffer};
+}
+
+void VkStandardRB::PrepareInstanceDraws() {
+    instanceDraws.clear();
+    uint32_t firstInstance = scene.Meshes().size();
+    for (const auto& instanceGroup : scene.InstanceGroups()) {
+        auto it = std::find(scene.Meshes().begin(), scene.Meshes().end(), instanceGroup->GetMesh());
+        if (it == scene.Meshes().end()) {
+            LOGGER(LOGGER::WARNING) << "Instance group references a mesh that is not part of the scene, skipping";
+        } else {
+            instanceDraws.push_back({static_cast<uint32_t>(std::distance(scene.Meshes().begin(), it)), firstInstance,
+                                     instanceGroup->Size()});
+        }
+        firstInstance += instanceGroup->Size();
+    }
+}
+
+void VkStandardRB::PrepareMeshData() {
+    const size_t meshCount = scene.Meshes().size();
+    meshBoundingSpheres.resize(meshCount);
+    meshBoxCenters.resize(meshCount);
+    meshBoxExtents.resize(meshCount);
+    meshFullLODs.resize(meshCount);
+    preparedMeshMaterials.resize(meshCount);
+    meshLODs.clear();
+    meshFirstLOD.assign(1, 0);
+    for (size_t i = 0; i < meshCount; ++i) {
+        auto& mesh = *scene.Meshes()[i];
+        meshBoundingSpheres[i] = glm::vec4(mesh.GetBoundsCenter(), mesh.GetBoundsRadius());
+        meshBoxCenters[i] = glm::vec4((mesh.GetBoundsMin() + mesh.GetBoundsMax()) * 0.5f, 1.0f);
+        meshBoxExtents[i] = glm::vec4((mesh.GetBoundsMax() - mesh.GetBoundsMin()) * 0.5f, 0.0f);
+        meshFullLODs[i] = mesh.GetFullLOD();
+        preparedMeshMaterials[i] = mesh.GetMaterialPtr().get();
+        meshLODs.insert(meshLODs.end(), mesh.GetLODs().begin(), mesh.GetLODs().end());
+        meshFirstLOD.push_back(static_cast<uint32_t>(meshLODs.size()));
+    }
+}
+
+// box given as center and half extent against the six inward planes of a view
+bool BoxInFrustum(const glm::vec4& center, const glm::vec4& extent, const glm::vec4* planes) {
+    for (int p = 0; p < 6; ++p) {
+        const glm::vec3 normal{planes[p]};
+        const float distance = glm::dot(normal, glm::vec3(center)) + planes[p].w;
+        if (distance < -glm::dot(glm::abs(normal), glm::vec3(extent))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool VkStandardRB::SelectLOD(uint32_t meshIndex, float viewportHeight, Mesh::LOD& lod) const {
+    lod = meshFullLODs[meshIndex];
+    // meshes without bounds are never culled. Cached frames leave view culling to the meshlet culling pass, which
+    // reads the planes every frame, otherwise every camera move would change the draw set and re-record
+    const bool viewCulling = !cacheCommandBuffers;
+    if (viewCulling && meshIndex < meshWorldBoxCenters.size() && meshBoundingSpheres[meshIndex].w > 0.0f) {
+        bool inAnyView = false;
+        for (uint32_t v = 0; v < frustumViewCount && !inAnyView; ++v) {
+            inAnyView = BoxInFrustum(meshWorldBoxCenters[meshIndex], meshWorldBoxExtents[meshIndex],
+                                     &frustumPlanes[v * 6]);
+        }
+        if (!inAnyView && frustumViewCount > 0) {
+            return false;
+        }
+    }
+
+    const auto lodsBegin = meshLODs.begin() + meshFirstLOD[meshIndex];
+    const auto lodsEnd = meshLODs.begin() + meshFirstLOD[meshIndex + 1];
+    if (lodsBegin == lodsEnd || meshIndex >= meshWorldMatrices.size()) {
+        return true;
+    }
+
+    const glm::mat4& model = meshWorldMatrices[meshIndex];
+    const float scale = std::max({glm::length(glm::vec3(model[0])), glm::length(glm::vec3(model[1])),
+                                  glm::length(glm::vec3(model[2]))});
+    const glm::vec4 center = model * glm::vec4(glm::vec3(meshBoundingSpheres[meshIndex]), 1.0f);
+    const float radius = meshBoundingSpheres[meshIndex].w * scale;
+
+    // pixels per world unit at distance 1, worst case over all views so neither eye sees popping
+    float maxPixelsPerUnit = 0.0f;
+    const uint32_t viewCount = stereo ? 2 : 1;
+    for (uint32_t v = 0; v < viewCount; ++v) {
+        const glm::mat4& view = stereo ? viewProjStereo.views[v] : viewProj.view;
+        const glm::mat4& proj = stereo ? viewProjStereo.projs[v] : viewProj.proj;
+
+        const float distance = glm::length(glm::vec3(view * center));
+        if (distance <= radius) {
+            // viewer is inside the bounds
+            return true;
+        }
+        maxPixelsPerUnit = std::max(maxPixelsPerUnit, std::abs(proj[1][1]) * viewportHeight * 0.5f / distance);
+    }
+
+    if (viewCulling && 2.0f * radius * maxPixelsPerUnit < subPixelCullSize) {
+        return false;
+    }
+
+    // coarsest level whose simplification error stays below the threshold on screen
+    for (auto it = lodsEnd; it != lodsBegin;) {
+        --it;
+        if (it->error * scale * maxPixelsPerUnit <= lodPixelErrorThreshold) {
+            lod = *it;
+            break;
+        }
+    }
+    return true;
+}
+
+ShaderVariant VkStandardRB::MaterialShaderVariant(const Material& material) {
+    ShaderVariant variant;
+    variant.features = 0;
+    variant.maxLights = maxLightsPerCluster;
+    variant.features |= material.Normal.IsPlaceholder() ? 0 : ShaderVariant::NORMAL_MAP;
+    variant.features |= material.IsEmissive() ? ShaderVariant::EMISSIVE : 0;
+    variant.features |= material.alphaTest ? ShaderVariant::ALPHA_TEST : 0;
+    return variant;
+}
+
+void VkStandardRB::PrecompileDefaultShaders(bool stereo) {
+    Shader::CompileAsync("", Shader::VERTEX_SHADER, stereo);
+    // walks every subset of materialVariantFeatures, the compilations of one subset are shared with Prepare
+    for (uint32_t features = materialVariantFeatures;; features = (features - 1) & materialVariantFeatures) {
+        ShaderVariant variant;
+        variant.features = features;
+        variant.maxLights = maxLightsPerCluster;
+        Shader::CompileAsync("", Shader::FRAGMENT_SHADER, stereo, {}, variant);
+        if (features == 0) {
+            break;
+        }
+    }
+    Shader::CompileAsync("", Shader::COMPUTE_SHADER, stereo, defaultMeshletCullComp);
+    Shader::CompileAsync("", Shader::COMPUTE_SHADER, stereo, defaultLightClusterComp);
+}
+
 void VkStandardRB::Prepare() {
+    PrepareInstanceDraws();
+    PrepareMeshData();
+    // one region per swapchain image, so a cached command buffer always reads the region of its own image
+    frameUniforms = std::make_unique<UniformRing>(core, swapchain->GetSwapchainImages().size(), frameUniformsSize);
     if (stereo) {
+        RegisterHeadMovementListener(viewProjStereo);
         PrepareDefaultRenderPasses(swapchain->GetSwapchainImages(),
-                                   std::move(CreateViewProjectionBuffer(core, viewProjStereo)));
+                                   {frameUniforms->GetBuffer(), sizeof(Primitives::ViewProjectionStereo)});
     } else {
         auto mainCamera = scene.MainCamera();
         viewProj.view = mainCamera->CameraView();
         viewProj.proj = mainCamera->CameraProjection();
         PrepareDefaultRenderPasses(swapchain->GetSwapchainImages(),
-                                   std::move(CreateViewProjectionBuffer(core, scene, viewProj)));
+                                   {frameUniforms->GetBuffer(), sizeof(Primitives::ViewProjection)});
+    }
+    // graphics pipelines build on workers, wait for them so the saved cache contains them
+    for (auto& pass : *renderPasses) {
+        auto vkPass = static_cast<VkGraphicsRenderpass*>(pass.get());
+        for (uint32_t variant = 0; variant < vkPass->VariantCount(); ++variant) {
+            vkPass->GetPipeline(variant);
+        }
     }
+    // all default pipelines exist now, persist them early rather than only on a clean shutdown
+    core.SavePipelineCache();
 }
 
 ////////////////////////////////////////////////////
@@ -458,6 +1329,8 @@ void VkStandardRB::Prepare() {
 ////////////////////////////////////////////////////
 bool VkStandardRB::StartFrame(uint32_t& imageIndex) {
     vkWaitForFences(core.GetRenderDevice(), 1, &core.GetInFlightFence(), VK_TRUE, UINT64_MAX);
+    // one frame in flight, every frame submitted so far has completed
+    textureHeap->ReleaseCompleted(submittedFrame);
 
     auto result = vkAcquireNextImageKHR(core.GetRenderDevice(), swapchain->GetSwaphcain(), UINT64_MAX,
                                         core.GetImageAvailableSemaphore(), VK_NULL_HANDLE, &imageIndex);
@@ -475,47 +1348,433 @@ bool VkStandardRB::StartFrame(uint32_t& imageIndex) {
 
 void VkStandardRB::RecordFrame(uint32_t& imageIndex) {
     vkResetFences(core.GetRenderDevice(), 1, &core.GetInFlightFence());
-    CommandBuffer commandBuffer{core};
-    vkResetCommandBuffer(commandBuffer.GetCommandBuffer(), 0);
-
-    // default frame recording
-    commandBuffer.StartRecord();
-    for (int i = 0; i < renderPasses->size(); ++i) {
-        auto currentPass = static_cast<VkGraphicsRenderpass*>(renderPasses->at(i).get());
-        RecordPass(commandBuffer, currentPass, i, imageIndex);
-
-        // add barrier synchronization between render passes
-        if (i != renderPasses->size() - 1) {
-            commandBuffer.BarrierBetweenPasses(imageIndex, *currentPass);
+    submittedFrame = textureHeap->BeginFrame();
+    // buffer contents change every frame, the commands reading them only when the signature does
+    ApplySnapshot(RenderingSnapshot());
+    WriteFrameUniforms(imageIndex);
+    // the cpu culling and lod selection of the recording
+    UpdateFrustumPlanes();
+
+    if (recordedFrames.size() <= imageIndex) {
+        recordedFrames.resize(imageIndex + 1);
+    }
+    auto& frame = recordedFrames[imageIndex];
+    const auto signature = cacheCommandBuffers ? FrameSignature(imageIndex) : std::array<uint64_t, 2>{};
+    if (!cacheCommandBuffers || !frame.valid || frame.signature != signature) {
+        // EndRecord waits for the queue, so the image's previous command buffers are no longer in use
+        core.ResetRecordingCommandPools(imageIndex);
+        frame.parallelPasses = 0;
+        if (frame.commandBuffer == nullptr) {
+            frame.commandBuffer = std::make_unique<CommandBuffer>(core);
+        }
+        auto& commandBuffer = *frame.commandBuffer;
+        vkResetCommandBuffer(commandBuffer.GetCommandBuffer(), 0);
+
+        // default frame recording
+        commandBuffer.StartRecord();
+        RecordMeshletCulling(commandBuffer);
+        RecordLightClustering(commandBuffer);
+        for (int i = 0; i < renderPasses->size(); ++i) {
+            auto currentPass = static_cast<VkGraphicsRenderpass*>(renderPasses->at(i).get());
+            RecordPass(commandBuffer, currentPass, i, imageIndex);
+
+            // add barrier synchronization between render passes
+            if (i != renderPasses->size() - 1) {
+                commandBuffer.BarrierBetweenPasses(imageIndex, *currentPass);
+            }
         }
+        commandBuffer.EndRecord();
+        frame.signature = signature;
+        frame.valid = true;
+    }
+
+    if (stereo) {
+        LateLatchPoses(imageIndex);
+        UpdateFrustumPlanes();
     }
+    // only mapped memory the recorded commands read, written last so the gpu culls and clusters with the views it
+    // renders
+    UpdateMeshletCullData();
+    UpdateLightClusterData();
 
     if (!stereo)
-        commandBuffer.EndRecord({core.GetImageAvailableSemaphore()}, {core.GetRenderFinishedSemaphore()},
-                                core.GetInFlightFence());
+        frame.commandBuffer->Submit({core.GetImageAvailableSemaphore()}, {core.GetRenderFinishedSemaphore()},
+                                    core.GetInFlightFence());
     else {
-        commandBuffer.EndRecord({}, {}, core.GetInFlightFence());
+        frame.commandBuffer->Submit({}, {}, core.GetInFlightFence());
+    }
+}
+
+void VkStandardRB::WriteFrameUniforms(uint32_t imageIndex) {
+    frameUniforms->BeginFrame(imageIndex);
+    if (stereo) {
+        frameUniformOffset = frameUniforms->Allocate(sizeof(viewProjStereo), &viewProjStereo);
+        return;
+    }
+    viewProj.view = RenderingSnapshot().cameraView;
+    viewProj.proj = RenderingSnapshot().cameraProjection;
+    frameUniformOffset = frameUniforms->Allocate(sizeof(viewProj), &viewProj);
+}
+
+void VkStandardRB::LateLatchPoses(uint32_t imageIndex) {
+    EventSystem::TriggerEvent(Events::XRLIB_EVENT_RENDERER_PRE_QUEUE_SUBMIT);
+    // allocations are replayed in the same order, so the offsets baked into the commands stay the same
+    WriteFrameUniforms(imageIndex);
+    // a pipelined simulation owns the scene by now, its controllers are only as recent as the snapshot.
+    // Otherwise only the controller subtrees are read again, the rest of the scene was extracted this frame
+    if (!pipelined) {
+        auto& snapshot = RenderingSnapshot();
+        latchedMeshes.clear();
+        for (auto tag : {Entity::TAG::MESH_LEFT_CONTROLLER, Entity::TAG::MESH_RIGHT_CONTROLLER}) {
+            snapshot.ExtractSubtrees(scene.EntitiesWithTag(tag), latchedMeshes);
+        }
+        ApplyMeshMatrices(snapshot, latchedMeshes);
     }
 }
+
+void VkStandardRB::ExtractSnapshot() {
+    snapshots[extractSlot].Extract(scene);
+}
+
+void VkStandardRB::SwapSnapshots() {
+    extractSlot ^= 1;
+}
+
+void VkStandardRB::ApplySnapshot(RenderSnapshot& snapshot) {
+    // cpu copies are kept for lod selection and change detection, mapped memory should only be written
+    auto models = static_cast<ModelData*>(modelBuffer->GetMappedData());
+    const size_t meshCount = std::min(snapshot.MeshCount(), meshWorldMatrices.size());
+    // world boxes are computed on the first frame and then only when a mesh moved
+    bool meshMoved = meshWorldBoxCenters.size() != meshCount;
+    for (size_t i = 0; i < meshCount; ++i) {
+        if (snapshot.meshWorldMatrices[i] != meshWorldMatrices[i]) {
+            meshWorldMatrices[i] = snapshot.meshWorldMatrices[i];
+            models[i] = MakeModelData(meshWorldMatrices[i]);
+            meshMoved = true;
+        }
+    }
+    if (meshMoved) {
+        meshWorldBoxCenters.resize(meshCount);
+        meshWorldBoxExtents.resize(meshCount);
+        BatchMath::TransformAABBs(meshWorldMatrices.data(), meshBoxCenters.data(), meshBoxExtents.data(),
+                                  meshWorldBoxCenters.data(), meshWorldBoxExtents.data(), meshCount);
+    }
+
+    // instances follow the meshes in the model buffer, groups added after Prepare have no room in it
+    const glm::mat4* transform = snapshot.instanceTransforms.data();
+    for (auto [firstInstance, count] : snapshot.instanceRanges) {
+        if (firstInstance + count <= preparedInstanceCount) {
+            WriteModelData(transform, count, models + meshWorldMatrices.size() + firstInstance);
+        }
+        transform += count;
+    }
+    snapshot.ConsumeInstanceUpdates();
+
+    auto lights = static_cast<Primitives::PointLightData*>(pointLightBuffer->GetMappedData());
+    const size_t lightCount = std::min(snapshot.PointLightCount(), preparedPointLights);
+    for (size_t i = 0; i < lightCount; ++i) {
+        Primitives::PointLightData packed{snapshot.lightPositionRanges[i], snapshot.lightColorIntensities[i]};
+        if (packed != uploadedPointLights[i]) {
+            uploadedPointLights[i] = packed;
+            lights[i] = packed;
+        }
+    }
+}
+
+void VkStandardRB::ApplyMeshMatrices(const RenderSnapshot& snapshot, std::span<const uint32_t> meshIndices) {
+    auto models = static_cast<ModelData*>(modelBuffer->GetMappedData());
+    for (uint32_t i : meshIndices) {
+        // boxes exist once ApplySnapshot ran, meshes added since have no model slot
+        if (i >= meshWorldBoxCenters.size()) {
+            continue;
+        }
+        meshWorldMatrices[i] = snapshot.meshWorldMatrices[i];
+        models[i] = MakeModelData(meshWorldMatrices[i]);
+        // kept current, the next ApplySnapshot only recomputes boxes when a matrix differs from this one
+        BatchMath::TransformAABBs(&meshWorldMatrices[i], &meshBoxCenters[i], &meshBoxExtents[i],
+                                  &meshWorldBoxCenters[i], &meshWorldBoxExtents[i], 1);
+    }
+}
+
+uint32_t VkStandardRB::MeshMaterialIndex(uint32_t meshIndex) {
+    // meshes added after Prepare have no entry in the material table, they draw with the first one
+    if (meshIndex >= meshMaterialIndices.size() || meshIndex >= preparedMeshMaterials.size()) {
+        return 0;
+    }
+    const auto& meshMaterials = RenderingSnapshot().meshMaterials;
+    const Material* material =
+        meshIndex < meshMaterials.size() ? meshMaterials[meshIndex] : preparedMeshMaterials[meshIndex];
+    if (material == preparedMeshMaterials[meshIndex]) {
+        return meshMaterialIndices[meshIndex];
+    }
+    // swapped to another material of the table, materials created after Prepare keep the prepared one
+    auto it = materialIndices.find(material);
+    return it != materialIndices.end() ? it->second : meshMaterialIndices[meshIndex];
+}
+
+void VkStandardRB::SetCommandBufferCaching(bool enable) {
+    cacheCommandBuffers = enable;
+    InvalidateRecordedFrames();
+}
+
+void VkStandardRB::InvalidateRecordedFrames() {
+    for (auto& frame : recordedFrames) {
+        frame.valid = false;
+    }
+}
+
+std::array<uint64_t, 2> VkStandardRB::FrameSignature(uint32_t imageIndex) {
+    const auto& snapshot = RenderingSnapshot();
+    signatureData.clear();
+    signatureData.push_back(snapshot.sceneGeneration);
+    signatureData.push_back(snapshot.MeshCount());
+    signatureData.push_back(snapshot.instanceGroupCount);
+    for (const auto& pass : *renderPasses) {
+        auto vkPass = static_cast<VkGraphicsRenderpass*>(pass.get());
+        signatureData.push_back(reinterpret_cast<uint64_t>(vkPass->GetPipeline().GetVkPipeline()));
+        signatureData.push_back(reinterpret_cast<uint64_t>(vkPass->GetRenderpass().GetFrameBuffers()[imageIndex]));
+    }
+
+    // the draw set, which meshes are visible and survive culling, at which level of detail and with which material
+    const float viewportHeight = static_cast<float>(swapchain->GetSwapchainImages()[0][0]->Height());
+    const size_t meshCount = std::min(snapshot.MeshCount(), meshFullLODs.size());
+    for (uint32_t i = 0; i < meshCount; ++i) {
+        Mesh::LOD lod;
+        const bool drawn = snapshot.meshVisible[i] && SelectLOD(i, viewportHeight, lod);
+        signatureData.push_back(drawn ? lod.firstIndex : UINT64_MAX);
+        signatureData.push_back(MeshMaterialIndex(i));
+    }
+    return Util::Hash128({reinterpret_cast<const char*>(signatureData.data()),
+                          signatureData.size() * sizeof(uint64_t)});
+}
+
+void VkStandardRB::UpdateFrustumPlanes() {
+    frustumViewCount = stereo ? 2 : 1;
+    for (uint32_t v = 0; v < frustumViewCount; ++v) {
+        const glm::mat4& view = stereo ? viewProjStereo.views[v] : viewProj.view;
+        const glm::mat4& proj = stereo ? viewProjStereo.projs[v] : viewProj.proj;
+        ExtractFrustumPlanes(proj * view, &frustumPlanes[v * 6]);
+    }
+}
+
+void VkStandardRB::UpdateMeshletCullData() {
+    if (meshletCulling.meshletCount == 0) {
+        return;
+    }
+
+    auto& cullData = *static_cast<MeshletCullData*>(meshletCulling.cullDataBuffer->GetMappedData());
+    cullData.viewCount = frustumViewCount;
+    cullData.meshletCount = meshletCulling.meshletCount;
+    std::copy(frustumPlanes.begin(), frustumPlanes.begin() + frustumViewCount * 6, cullData.planes);
+    for (uint32_t v = 0; v < cullData.viewCount; ++v) {
+        const glm::mat4& view = stereo ? viewProjStereo.views[v] : viewProj.view;
+        cullData.cameraPos[v] = glm::inverse(view)[3];
+    }
+}
+
+void VkStandardRB::RecordMeshletCulling(CommandBuffer& commandBuffer) {
+    if (meshletCulling.meshletCount == 0) {
+        return;
+    }
+
+    auto drawCommandBuffer = meshletCulling.drawCommandBuffer->GetBuffer();
+    commandBuffer
+        .CopyBuffer(meshletCulling.drawCommandResetBuffer->GetBuffer(), drawCommandBuffer,
+                    meshletCulling.drawCommandBuffer->GetSize())
+        .BufferBarrier(drawCommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+                       VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT)
+        .Dispatch(*meshletCulling.pipeline, meshletCulling.descriptorSets, meshletCulling.meshletCount)
+        .BufferBarrier(drawCommandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_WRITE_BIT,
+                       VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT)
+        .BufferBarrier(meshletCulling.culledIndexBuffer->GetBuffer(), VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                       VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_ACCESS_INDEX_READ_BIT);
+}
+
+void VkStandardRB::UpdateLightClusterData() {
+    if (lightClustering.pipeline == nullptr) {
+        return;
+    }
+
+    auto& clusterInfo = *static_cast<ClusterInfo*>(lightClustering.clusterInfoBuffer->GetMappedData());
+    const uint32_t viewCount = stereo ? 2 : 1;
+    // one slice distribution for all views, spanning the depth range of every view
+    glm::vec2 depthRange{std::numeric_limits<float>::max(), 0.0f};
+    for (uint32_t v = 0; v < viewCount; ++v) {
+        clusterInfo.views[v] = stereo ? viewProjStereo.views[v] : viewProj.view;
+        clusterInfo.invProjs[v] = glm::inverse(stereo ? viewProjStereo.projs[v] : viewProj.proj);
+        glm::vec2 viewRange = ProjectionDepthRange(clusterInfo.invProjs[v], clusterMaxDepthRatio);
+        depthRange = {std::min(depthRange.x, viewRange.x), std::max(depthRange.y, viewRange.y)};
+    }
+    auto renderTarget = swapchain->GetSwapchainImages()[0][0];
+    clusterInfo.depthAndViewport = {depthRange.x, depthRange.y, static_cast<float>(renderTarget->Width()),
+                                    static_cast<float>(renderTarget->Height())};
+}
+
+void VkStandardRB::RecordLightClustering(CommandBuffer& commandBuffer) {
+    if (lightClustering.pipeline == nullptr) {
+        return;
+    }
+
+    const uint32_t viewCount = stereo ? 2 : 1;
+    const uint32_t clustersPerView = clusterGridX * clusterGridY * clusterGridZ;
+    commandBuffer.Dispatch(*lightClustering.pipeline, lightClustering.descriptorSets, (clustersPerView + 63) / 64,
+                           viewCount);
+
+    // counts and indices are read by the fragment shaders of the following passes
+    for (auto& buffer : {lightClustering.clusterLightCountsBuffer, lightClustering.clusterLightIndicesBuffer}) {
+        commandBuffer.BufferBarrier(buffer->GetBuffer(), VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                                    VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                                    VK_ACCESS_SHADER_READ_BIT);
+    }
+}
+
 void VkStandardRB::RecordPass(CommandBuffer& commandBuffer, VkGraphicsRenderpass* currentPass, uint8_t currentPassIndex,
                               uint32_t& imageIndex) {
-    commandBuffer.StartPass(*currentPass, imageIndex).BindDescriptorSets(*currentPass, 0);
-    for (uint32_t i = 0; i < scene.Meshes().size(); ++i) {
-        commandBuffer.PushConstant(*currentPass, sizeof(uint32_t), &i);
-        if (!vertexBuffers.empty() && !indexBuffers.empty() && vertexBuffers[i] != nullptr &&
-            indexBuffers[i] != nullptr) {
-            commandBuffer.BindVertexBuffer(0, {vertexBuffers[i]->GetBuffer()}, {0})
-                .BindIndexBuffer(indexBuffers[i]->GetBuffer(), 0);
+    const float viewportHeight = static_cast<float>(swapchain->GetSwapchainImages()[0][0]->Height());
+    const glm::mat4& view = stereo ? viewProjStereo.views[0] : viewProj.view;
+    // material variants are pipelines of the default pass, other passes fall back to their only pipeline
+    auto materialPipeline = [this, currentPass](uint32_t materialIndex) {
+        const uint32_t variant = materialIndex < materialVariants.size() ? materialVariants[materialIndex] : 0;
+        return std::pair{variant, currentPass->GetPipeline(variant).GetVkPipeline()};
+    };
+
+    const auto& snapshot = RenderingSnapshot();
+    drawList.Clear();
+    const size_t meshCount = std::min(snapshot.MeshCount(), meshFullLODs.size());
+    for (uint32_t i = 0; i < meshCount; ++i) {
+        Mesh::LOD lod;
+        if (!snapshot.meshVisible[i] || !SelectLOD(i, viewportHeight, lod)) {
+            continue;
+        }
+        if (vertexBuffers.empty() || indexBuffers.empty() || vertexBuffers[i] == nullptr ||
+            indexBuffers[i] == nullptr) {
+            continue;
+        }
+
+        DrawList::Draw draw;
+        draw.pushConstants = {i, MeshMaterialIndex(i)};
+        const auto [pipelineId, pipeline] = materialPipeline(draw.pushConstants.materialIndex);
+        draw.pipeline = pipeline;
+        draw.vertexBuffer = vertexBuffers[i]->GetBuffer();
+        draw.indexBuffer = indexBuffers[i]->GetBuffer();
+        draw.indexCount = lod.indexCount;
+        draw.firstIndex = lod.firstIndex;
+        draw.firstInstance = i;
+
+        // full resolution of large meshes goes through the meshlets that survived the cull pass
+        const int32_t meshletDraw = meshletCulling.meshletCount == 0 ? -1 : meshletCulling.drawIndices[i];
+        if (meshletDraw >= 0 && lod.indexCount == meshFullLODs[i].indexCount) {
+            draw.indexBuffer = meshletCulling.culledIndexBuffer->GetBuffer();
+            draw.indexType = VK_INDEX_TYPE_UINT32;
+            draw.indirectBuffer = meshletCulling.drawCommandBuffer->GetBuffer();
+            draw.indirectOffset = meshletDraw * sizeof(VkDrawIndexedIndirectCommand);
+        }
+
+        float viewDepth = 0.0f;
+        if (i < meshWorldMatrices.size()) {
+            const glm::vec4 center = meshWorldMatrices[i] * glm::vec4(glm::vec3(meshBoundingSpheres[i]), 1.0f);
+            viewDepth = -(view * center).z;
         }
+        drawList.Add(DrawList::MakeKey(currentPassIndex, pipelineId, draw.pushConstants.materialIndex, i, viewDepth),
+                     draw);
+    }
+
+    // one instanced draw per instance group
+    for (const auto& instanceDraw : instanceDraws) {
+        if (instanceDraw.meshIndex >= std::min(vertexBuffers.size(), indexBuffers.size()) ||
+            vertexBuffers[instanceDraw.meshIndex] == nullptr || indexBuffers[instanceDraw.meshIndex] == nullptr) {
+            continue;
+        }
+        // instances are spread out, so always the full resolution level and no single depth to sort by
+        Mesh::LOD instanceLOD = meshFullLODs[instanceDraw.meshIndex];
+        DrawList::Draw draw;
+        draw.pushConstants = {instanceDraw.meshIndex, MeshMaterialIndex(instanceDraw.meshIndex)};
+        const auto [pipelineId, pipeline] = materialPipeline(draw.pushConstants.materialIndex);
+        draw.pipeline = pipeline;
+        draw.vertexBuffer = vertexBuffers[instanceDraw.meshIndex]->GetBuffer();
+        draw.indexBuffer = indexBuffers[instanceDraw.meshIndex]->GetBuffer();
+        draw.indexCount = instanceLOD.indexCount;
+        draw.instanceCount = instanceDraw.instanceCount;
+        draw.firstIndex = instanceLOD.firstIndex;
+        draw.firstInstance = instanceDraw.firstInstance;
+        drawList.Add(DrawList::MakeKey(currentPassIndex, pipelineId, draw.pushConstants.materialIndex,
+                                       instanceDraw.meshIndex, 0.0f),
+                     draw);
+    }
 
-        commandBuffer.DrawIndexed(scene.Meshes()[i]->GetIndices().size(), 1, 0, 0, 0);
+    drawList.Sort();
+
+    // every dynamic uniform of the pass reads the frame's region of the uniform ring
+    uint32_t dynamicOffsetCount = 0;
+    for (const auto& descriptorSet : currentPass->GetDescriptorSets()) {
+        dynamicOffsetCount += descriptorSet != nullptr ? descriptorSet->GetDynamicOffsetCount() : 0;
     }
+    const std::pmr::vector<uint32_t> dynamicOffsets(dynamicOffsetCount, frameUniformOffset, &FrameArena::ThreadLocal());
 
     // represents how many passes left to draw
-    EventSystem::TriggerEvent<int, CommandBuffer&>(Events::XRLIB_EVENT_RENDERER_PRE_SUBMITTING,
-                                                   (renderPasses->size() - 1) - currentPassIndex, commandBuffer);
+    const int passesLeft = (renderPasses->size() - 1) - currentPassIndex;
+    if (drawList.Size() < parallelRecordThreshold) {
+        commandBuffer.StartPass(*currentPass, imageIndex)
+            .BindDescriptorSets(*currentPass, 0, dynamicOffsets.size(), dynamicOffsets.data());
+        drawList.Record(commandBuffer, *currentPass);
+        EventSystem::TriggerEvent<int, CommandBuffer&>(Events::XRLIB_EVENT_RENDERER_PRE_SUBMITTING, passesLeft,
+                                                       commandBuffer);
+        commandBuffer.EndPass();
+        return;
+    }
+
+    commandBuffer.StartPass(*currentPass, imageIndex, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+    const size_t workerCount =
+        std::min<size_t>({VkCore::maxRecordingWorkers, std::max(1u, std::thread::hardware_concurrency()),
+                          (drawList.Size() + minDrawsPerRecordingWorker - 1) / minDrawsPerRecordingWorker});
+    const size_t drawsPerWorker = (drawList.Size() + workerCount - 1) / workerCount;
+    auto& frame = recordedFrames[imageIndex];
+    if (frame.secondaryCommandBuffers.size() <= frame.parallelPasses) {
+        frame.secondaryCommandBuffers.resize(frame.parallelPasses + 1);
+    }
+    auto& secondaryCommandBuffers = frame.secondaryCommandBuffers[frame.parallelPasses++];
+    // allocated once on this thread, recording them later only needs their pool to be used by a single thread
+    for (size_t worker = 0; worker < workerCount; ++worker) {
+        if (secondaryCommandBuffers[worker] == nullptr) {
+            secondaryCommandBuffers[worker] = std::make_unique<CommandBuffer>(
+                core, VK_COMMAND_BUFFER_LEVEL_SECONDARY, core.GetRecordingCommandPool(imageIndex, worker));
+        }
+    }
+    auto& listenerSlot = secondaryCommandBuffers[VkCore::maxRecordingWorkers];
+    if (listenerSlot == nullptr) {
+        // pool 0 is idle again once the workers are done, the listeners are recorded after them
+        listenerSlot = std::make_unique<CommandBuffer>(core, VK_COMMAND_BUFFER_LEVEL_SECONDARY,
+                                                       core.GetRecordingCommandPool(imageIndex, 0));
+    }
 
-    commandBuffer.EndPass();
+    if (recordingWorkers == nullptr) {
+        const size_t threadCount =
+            std::min<size_t>(VkCore::maxRecordingWorkers, std::max(1u, std::thread::hardware_concurrency()));
+        recordingWorkers = std::make_unique<WorkerPool>(threadCount - 1);
+    }
+    // worker w only touches pool w and its own command buffer, so no locking is needed
+    recordingWorkers->Run(workerCount, [&](size_t worker) {
+        auto& secondary = *secondaryCommandBuffers[worker];
+        secondary.StartSecondaryRecord(*currentPass, imageIndex)
+            .BindDescriptorSets(*currentPass, 0, dynamicOffsets.size(), dynamicOffsets.data());
+        drawList.Record(secondary, *currentPass, worker * drawsPerWorker, drawsPerWorker);
+        secondary.EndSecondaryRecord();
+    });
+
+    // listeners record inline, give them a secondary command buffer of their own on this thread
+    auto& listenerCommands = *listenerSlot;
+    listenerCommands.StartSecondaryRecord(*currentPass, imageIndex)
+        .BindDescriptorSets(*currentPass, 0, dynamicOffsets.size(), dynamicOffsets.data());
+    EventSystem::TriggerEvent<int, CommandBuffer&>(Events::XRLIB_EVENT_RENDERER_PRE_SUBMITTING, passesLeft,
+                                                   listenerCommands);
+    listenerCommands.EndSecondaryRecord();
+
+    std::vector<VkCommandBuffer> secondaries;
+    for (size_t worker = 0; worker < workerCount; ++worker) {
+        secondaries.push_back(secondaryCommandBuffers[worker]->GetCommandBuffer());
+    }
+    secondaries.push_back(listenerCommands.GetCommandBuffer());
+    commandBuffer.ExecuteCommands(secondaries).EndPass();
 }
 
 void VkStandardRB::EndFrame(uint32_t& imageIndex) {
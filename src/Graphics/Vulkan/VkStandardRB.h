@@ -2,8 +2,13 @@
 
 #include "Buffer.h"
 #include "CommandBuffer.h"
+#include "DrawList.h"
+#include "Graphics/RenderSnapshot.h"
 #include "Graphics/StandardRB.h"
 #include "Swapchain.h"
+#include "TextureHeap.h"
+#include "UniformRing.h"
+#include "Utils/WorkerPool.h"
 #include "VkGraphicsRenderpass.h"
 
 // Vulkan Standard Rendering Behavior
@@ -23,9 +28,38 @@ class VkStandardRB : public StandardRB {
     static const std::string_view defaultVertStereo;
     static const std::string_view defaultPhongFrag;
     static const std::string_view defaultPBRFrag;
+    static const std::string_view defaultMeshletCullComp;
+    static const std::string_view defaultLightClusterComp;
 
     inline constexpr static std::string_view defaultShaderCachePath = "./ShaderCache";
 
+    // per image bytes of the frame uniform ring, holds the view projection of the default passes
+    inline constexpr static VkDeviceSize frameUniformsSize = 1024;
+
+    // starts compiling the default shaders on workers, Prepare picks up the results. Materials are not loaded
+    // yet, so every fragment variant the default MaterialShaderVariant can select is compiled
+    static void PrecompileDefaultShaders(bool stereo);
+
+    // features MaterialShaderVariant switches per material, the default pass has at most one pipeline per subset
+    inline constexpr static uint32_t materialVariantFeatures =
+        ShaderVariant::NORMAL_MAP | ShaderVariant::EMISSIVE | ShaderVariant::ALPHA_TEST;
+
+    // screen space thresholds in pixels for lod selection and small object culling
+    inline constexpr static float lodPixelErrorThreshold = 1.0f;
+    inline constexpr static float subPixelCullSize = 1.0f;
+
+    // froxel grid per view for clustered lighting, depth slices are exponential between the near and far plane of
+    // the active projections. Infinite far planes are capped at clusterMaxDepthRatio times the near plane
+    inline constexpr static uint32_t clusterGridX = 16;
+    inline constexpr static uint32_t clusterGridY = 9;
+    inline constexpr static uint32_t clusterGridZ = 24;
+    inline constexpr static uint32_t maxLightsPerCluster = 64;
+    inline constexpr static float clusterMaxDepthRatio = 100000.0f;
+
+    // passes with fewer draws are recorded inline, larger ones into secondary command buffers on workers
+    inline constexpr static size_t parallelRecordThreshold = 512;
+    inline constexpr static size_t minDrawsPerRecordingWorker = 128;
+
     ////////////////////////////////////////////////////
     // Default render passes
     ////////////////////////////////////////////////////
@@ -39,25 +73,156 @@ class VkStandardRB : public StandardRB {
     ////////////////////////////////////////////////////
 
     std::unique_ptr<Swapchain>& GetSwapchain() { return swapchain; }
+    // bindless textures of the default pass, valid after Prepare
+    TextureHeap& GetTextureHeap() { return *textureHeap; }
+    // records one command buffer per image and submits it again while the frame signature (scene generation,
+    // pipelines, framebuffers and the lod set) is unchanged. Per frame data has to come from buffers and
+    // PRE_SUBMITTING listeners only run when a frame is re-recorded, call InvalidateRecordedFrames to force it.
+    // The cpu frustum and sub pixel culling is skipped while caching so camera movement keeps the frames valid,
+    // culling is left to the gpu meshlet pass. Lod changes still re-record, the draws keep the depth order of the
+    // last recording
+    void SetCommandBufferCaching(bool enable);
+    void InvalidateRecordedFrames();
+
     bool StartFrame(uint32_t& imageIndex) override;
     void RecordFrame(uint32_t& imageIndex) override;
     void EndFrame(uint32_t& imageIndex) override;
+    void ExtractSnapshot() override;
+    void SwapSnapshots() override;
 
    protected:
     virtual void RecordPass(CommandBuffer& commandBuffer, VkGraphicsRenderpass* pass, uint8_t passIndex,
                             uint32_t& imageIndex);
+    // copies the current camera into the frame uniform region of the image
+    void WriteFrameUniforms(uint32_t imageIndex);
+    // gives PRE_QUEUE_SUBMIT listeners a chance to update head and controller poses, then rewrites the frame
+    // uniforms and model data the recorded commands read. Both are host visible and the gpu has not started yet
+    void LateLatchPoses(uint32_t imageIndex);
+    // writes what changed into the mapped model and light buffers, runs on the render thread
+    void ApplySnapshot(RenderSnapshot& snapshot);
+    // writes the model data and world boxes of the given meshes only
+    void ApplyMeshMatrices(const RenderSnapshot& snapshot, std::span<const uint32_t> meshIndices);
+    // the snapshot of the frame being recorded, the other one is extracted into meanwhile
+    RenderSnapshot& RenderingSnapshot() { return snapshots[extractSlot ^ 1]; }
+    // material table entry of a mesh in the rendered snapshot, 0 for meshes the table was not built for
+    uint32_t MeshMaterialIndex(uint32_t meshIndex);
+    // frustum planes of every view from the current camera, for the cpu and the meshlet culling
+    void UpdateFrustumPlanes();
+    void UpdateMeshletCullData();
+    void RecordMeshletCulling(CommandBuffer& commandBuffer);
+    void UpdateLightClusterData();
+    void RecordLightClustering(CommandBuffer& commandBuffer);
+    // hash of everything that is baked into the commands of a frame
+    std::array<uint64_t, 2> FrameSignature(uint32_t imageIndex);
+    // variant of the default fragment shader a material is drawn with, features without a texture are compiled
+    // out. The default pass builds one pipeline per distinct variant
+    virtual ShaderVariant MaterialShaderVariant(const Material& material);
 
    private:
     void PrepareDefaultRenderPasses(std::vector<std::vector<Image*>>& swapchainImages,
-                                    std::shared_ptr<Buffer> viewProjBuffer);
+                                    DynamicUniform viewProjUniform);
+    void PrepareInstanceDraws();
+    // copies the per mesh data lod selection and draw building need, so recording never touches the meshes
+    void PrepareMeshData();
+    void PrepareMeshletCulling(std::shared_ptr<Buffer> modelPositionsBuffer);
+    // returns cluster info, per cluster light counts and light indices for the lighting descriptor set
+    std::tuple<std::shared_ptr<Buffer>, std::shared_ptr<Buffer>, std::shared_ptr<Buffer>>
+    PrepareLightClustering(std::shared_ptr<Buffer> lightsCountBuffer, std::shared_ptr<Buffer> lightsBuffer);
+
+    // picks the coarsest lod that is still visually exact, returns false if the mesh is outside the frustum or sub
+    // pixel in every view. Never culls while command buffers are cached
+    bool SelectLOD(uint32_t meshIndex, float viewportHeight, Mesh::LOD& lod) const;
 
    protected:
+    struct InstanceDraw {
+        uint32_t meshIndex;
+        uint32_t firstInstance;
+        uint32_t instanceCount;
+    };
+
     VkCore& core;
     Primitives::ViewProjectionStereo viewProjStereo;
     Primitives::ViewProjection viewProj;
     std::vector<std::unique_ptr<Buffer>> vertexBuffers;
     std::vector<std::unique_ptr<Buffer>> indexBuffers;
+    std::vector<InstanceDraw> instanceDraws;
+    std::vector<glm::mat4> meshWorldMatrices;    // applied from the snapshot, owned by the render thread
+    std::vector<uint32_t> meshMaterialIndices;    // per mesh, its entry in the material table
+    std::vector<const Material*> preparedMeshMaterials;
+    std::unordered_map<const Material*, uint32_t> materialIndices;
+    std::vector<uint32_t> materialVariants;    // per material table entry, its pipeline variant of the default pass
+
+    // prepared per mesh data, indexed like the scene's meshes. The lods of mesh i are
+    // meshLODs[meshFirstLOD[i], meshFirstLOD[i + 1])
+    std::vector<glm::vec4> meshBoundingSpheres;    // object space center and radius
+    std::vector<glm::vec4> meshBoxCenters;    // object space box as center and half extent
+    std::vector<glm::vec4> meshBoxExtents;
+    // world space boxes, recomputed in one batch whenever a mesh moved
+    std::vector<glm::vec4> meshWorldBoxCenters;
+    std::vector<glm::vec4> meshWorldBoxExtents;
+    std::vector<Mesh::LOD> meshFullLODs;
+    std::vector<Mesh::LOD> meshLODs;
+    std::vector<uint32_t> meshFirstLOD;
+
+    // gpu culling of meshlets for large meshes, writes one indirect draw per mesh
+    struct MeshletCulling {
+        uint32_t meshletCount{0};
+        std::vector<int32_t> drawIndices;    // per mesh, its indirect command or -1
+        std::shared_ptr<Buffer> cullDataBuffer;
+        std::shared_ptr<Buffer> culledIndexBuffer;
+        std::shared_ptr<Buffer> drawCommandBuffer;
+        std::unique_ptr<Buffer> drawCommandResetBuffer;
+        std::vector<std::unique_ptr<DescriptorSet>> descriptorSets;
+        std::unique_ptr<Pipeline> pipeline;
+    } meshletCulling;
+
+    // per frame light assignment to the froxels of every view
+    struct LightClustering {
+        std::shared_ptr<Buffer> clusterInfoBuffer;
+        std::shared_ptr<Buffer> clusterLightCountsBuffer;
+        std::shared_ptr<Buffer> clusterLightIndicesBuffer;
+        std::vector<std::unique_ptr<DescriptorSet>> descriptorSets;
+        std::unique_ptr<Pipeline> pipeline;
+    } lightClustering;
     std::unique_ptr<Swapchain> swapchain;
+    std::unique_ptr<TextureHeap> textureHeap;
+    uint64_t submittedFrame{0};    // texture heap number of the last recorded frame, guarded by the frame fence
+    // scene state handed from the simulation to the renderer. The simulation extracts into one slot while the
+    // other one is rendered, SwapSnapshots flips them
+    std::array<RenderSnapshot, 2> snapshots;
+    uint32_t extractSlot{0};
+    size_t preparedInstanceCount{0};
+    size_t preparedPointLights{0};
+    std::shared_ptr<Buffer> modelBuffer;
+    std::shared_ptr<Buffer> pointLightBuffer;
+    std::vector<Primitives::PointLightData> uploadedPointLights;
+
+    std::array<glm::vec4, 12> frustumPlanes;    // six inward planes per view
+    uint32_t frustumViewCount{0};
+
+    std::unique_ptr<UniformRing> frameUniforms;
+    uint32_t frameUniformOffset{0};
+    // rebuilt for every pass, kept as a member so its storage is reused across frames
+    DrawList drawList;
+    // meshes moved by the late latch of the current frame
+    std::vector<uint32_t> latchedMeshes;
+
+    // per swapchain image, re-recorded every frame unless command buffer caching is enabled
+    struct RecordedFrame {
+        std::unique_ptr<CommandBuffer> commandBuffer;
+        // per parallel pass one secondary for every recording worker and the last one for the listeners. They are
+        // kept and recorded again from their reset pools, passes beyond parallelPasses are unused this recording
+        std::vector<std::array<std::unique_ptr<CommandBuffer>, VkCore::maxRecordingWorkers + 1>>
+            secondaryCommandBuffers;
+        uint32_t parallelPasses{0};
+        std::array<uint64_t, 2> signature{};
+        bool valid{false};
+    };
+    std::vector<RecordedFrame> recordedFrames;
+    // created with the first parallel pass, the calling thread records too so it holds one thread less
+    std::unique_ptr<WorkerPool> recordingWorkers;
+    std::vector<uint64_t> signatureData;
+    bool cacheCommandBuffers{false};
 };
 }    // namespace Graphics
 }    // namespace XRLib
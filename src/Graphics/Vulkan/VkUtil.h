@@ -8,6 +8,28 @@
 
 namespace XRLib {
 namespace Graphics {
+// vertex input layout per vertex type, specialize it for every type used as a vertex buffer
+template <typename T>
+struct VertexLayout;
+
+template <>
+struct VertexLayout<Primitives::Vertex> {
+    static constexpr std::array<VkVertexInputAttributeDescription, 3> attributes{{
+        {0, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Primitives::Vertex, position)},
+        {1, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Primitives::Vertex, normal)},
+        {2, 0, VK_FORMAT_R32G32_SFLOAT, offsetof(Primitives::Vertex, texCoords)},
+    }};
+};
+
+template <>
+struct VertexLayout<Primitives::QuantizedVertex> {
+    static constexpr std::array<VkVertexInputAttributeDescription, 3> attributes{{
+        {0, 0, VK_FORMAT_R16G16B16A16_UNORM, offsetof(Primitives::QuantizedVertex, position)},
+        {1, 0, VK_FORMAT_R16G16_SNORM, offsetof(Primitives::QuantizedVertex, normal)},
+        {2, 0, VK_FORMAT_R16G16_SFLOAT, offsetof(Primitives::QuantizedVertex, texCoords)},
+    }};
+};
+
 class VkUtil {
    public:
     template <typename T, typename Func, typename... Args>
@@ -78,9 +100,15 @@ class VkUtil {
                                    VK_IMAGE_TILING_OPTIMAL, VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT);
     }
 
-    static VkVertexInputBindingDescription GetVertexBindingDescription();
+    template <typename T = Primitives::RenderVertex>
+    static constexpr VkVertexInputBindingDescription GetVertexBindingDescription() {
+        return {0, sizeof(T), VK_VERTEX_INPUT_RATE_VERTEX};
+    }
 
-    static std::array<VkVertexInputAttributeDescription, 3> GetVertexAttributeDescription();
+    template <typename T = Primitives::RenderVertex>
+    static constexpr auto GetVertexAttributeDescription() {
+        return VertexLayout<T>::attributes;
+    }
 };
 }    // namespace Graphics
 }    // namespace XRLib
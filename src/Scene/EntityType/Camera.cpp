@@ -2,8 +2,10 @@
 
 namespace XRLib {
 
-Camera::Camera(glm::vec3 cameraPos, glm::vec3 cameraUp, glm::vec3 cameraFront, const std::string& name)
-    : cameraUp{cameraUp}, Entity{glm::inverse(glm::lookAt(cameraPos, cameraPos + cameraFront, cameraUp)), name} {
+Camera::Camera(TransformStore& transforms, glm::vec3 cameraPos, glm::vec3 cameraUp, glm::vec3 cameraFront,
+               const std::string& name)
+    : cameraUp{cameraUp},
+      Entity{transforms, glm::inverse(glm::lookAt(cameraPos, cameraPos + cameraFront, cameraUp)), name} {
     LOGGER(LOGGER::DEBUG) << glm::to_string(glm::lookAt(cameraPos, cameraPos + cameraFront, cameraUp));
 }
 
@@ -21,8 +23,8 @@ glm::vec3 extractCamPosition(const glm::mat4& viewMatrix) {
 }
 
 void Camera::UpdateCamera(glm::vec3 cameraFront) {
-    glm::vec3 cameraPos = extractCamPosition(glm::inverse(this->transform.GetMatrix()));
-    this->transform = {glm::inverse(glm::lookAt(cameraPos, cameraPos + cameraFront, cameraUp))};
+    glm::vec3 cameraPos = extractCamPosition(glm::inverse(GetLocalTransform().GetMatrix()));
+    GetLocalTransform() = {glm::inverse(glm::lookAt(cameraPos, cameraPos + cameraFront, cameraUp))};
 }
 
 glm::mat4 Camera::CameraView() {
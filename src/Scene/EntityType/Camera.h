@@ -7,7 +7,8 @@
 namespace XRLib {
 class Camera : public Entity {
    public:
-    Camera(glm::vec3 cameraPos = glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3 cameraUp = glm::vec3(0.0f, 1.0f, 0.0f),
+    Camera(TransformStore& transforms, glm::vec3 cameraPos = glm::vec3(0.0f, 0.0f, 0.0f),
+           glm::vec3 cameraUp = glm::vec3(0.0f, 1.0f, 0.0f),
            glm::vec3 cameraFront = glm::vec3(0.0f, 0.0f, -1.0f), const std::string& name = "DefaultCamera");
     ~Camera() = default;
 
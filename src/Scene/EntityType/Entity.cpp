@@ -0,0 +1,23 @@
+#include "Entity.h"
+#include "Scene/Scene.h"
+
+namespace XRLib {
+
+void* Entity::operator new(size_t size, Scene& scene) {
+    return scene.AllocateNode(size, alignof(std::max_align_t));
+}
+
+void* Entity::operator new(size_t size, std::align_val_t alignment, Scene& scene) {
+    return scene.AllocateNode(size, static_cast<size_t>(alignment));
+}
+
+Entity::~Entity() {
+    // children hold handles parented to ours, release them first
+    childs.clear();
+    if (taggingScene != nullptr) {
+        taggingScene->RemoveTags(this);
+    }
+    transforms.Free(transformHandle);
+}
+
+}    // namespace XRLib
@@ -1,43 +1,72 @@
 #pragma once
 
+#include "Scene/TransformStore.h"
+#include "Utils/NameTable.h"
 #include "Utils/Transform.h"
 
 namespace XRLib {
+class Scene;
+
 class Entity {
    public:
-    Entity(Transform transform, const std::string& name) : transform{transform}, name{name} {}
-    Entity(Transform transform) : transform{transform}, name{"DefaultEntity}"} {}
-    Entity(std::string name) : transform{}, name{name} {}
-    Entity() : transform{}, name{"DefaultEntity"} {}
-    ~Entity() = default;
+    // entities are created with Scene::Create, which passes the scene's transform store
+    Entity(TransformStore& transforms, Transform transform, const std::string& name)
+        : transforms{transforms}, transformHandle{transforms.Allocate(transform)}, name{&NameTable::Intern(name)} {}
+    Entity(TransformStore& transforms, Transform transform)
+        : transforms{transforms},
+          transformHandle{transforms.Allocate(transform)},
+          name{&NameTable::Intern("DefaultEntity")} {}
+    Entity(TransformStore& transforms, std::string name)
+        : transforms{transforms}, transformHandle{transforms.Allocate({})}, name{&NameTable::Intern(name)} {}
+    explicit Entity(TransformStore& transforms)
+        : transforms{transforms}, transformHandle{transforms.Allocate({})}, name{&NameTable::Intern("DefaultEntity")} {}
+    // leaves the tag lists of its scene, so they never hold destroyed entities
+    virtual ~Entity();
+
+    // entities live in the node arena of their scene, which releases their memory all at once when the scene is
+    // destroyed. Deleting an entity only runs its destructor, plain new is not available
+    static void* operator new(size_t size, Scene& scene);
+    static void* operator new(size_t size, std::align_val_t alignment, Scene& scene);
+    static void* operator new(size_t size) = delete;
+    static void operator delete(void*) {}
+    static void operator delete(void*, std::align_val_t) {}
+    // only called when a constructor throws
+    static void operator delete(void*, Scene&) {}
+    static void operator delete(void*, std::align_val_t, Scene&) {}
 
     enum TAG {
         MAIN_CAMERA,
         MESH_LEFT_CONTROLLER,
         MESH_RIGHT_CONTROLLER,
+        TAG_COUNT,
     };
+    // one bit per tag
+    using TagMask = uint32_t;
+    static_assert(TAG_COUNT <= sizeof(TagMask) * 8);
 
     std::vector<std::unique_ptr<Entity>>& GetChilds() { return childs; }
     Entity* GetParent() { return parent; }
-    void SetParent(Entity* parent) { this->parent = parent; }
+    // the parent has to belong to the same scene
+    void SetParent(Entity* parent) {
+        this->parent = parent;
+        transforms.SetParent(transformHandle,
+                             parent == nullptr ? TransformStore::invalidHandle : parent->transformHandle);
+    }
     bool IsRoot() { return parent == nullptr; }
 
-    Transform& GetLocalTransform() { return transform; }
-    const Transform GetGlobalTransform() {
-        Transform globalTransform = transform;
-        Entity* current = this;
-
-        while (current->parent != nullptr) {
-            globalTransform = current->parent->transform * globalTransform;
-            current = current->parent;
-        }
-
-        return globalTransform;
-    }
+    Transform& GetLocalTransform() { return transforms.Local(transformHandle); }
+    const Transform GetGlobalTransform() { return {transforms.ComputeWorld(transformHandle)}; }
+    // world matrix as of the last Scene::UpdateTransforms, no parent walk
+    glm::mat4 GetWorldMatrix() { return transforms.World(transformHandle); }
 
-    const std::string& GetName() { return name; }
-    void Rename(const std::string& n) { name = n; }
-    std::vector<TAG>& Tags() { return tags; }
+    const std::string& GetName() { return *name; }
+    // the previous name stays interned, NameTable never releases names, so avoid renaming to unique names per frame
+    void Rename(const std::string& n) { name = &NameTable::Intern(n); }
+    // tags are added and removed through the scene, which keeps a list of the entities of every tag. An entity is
+    // tagged in one scene only
+    TagMask Tags() const { return tags; }
+    bool HasTag(TAG tag) const { return (tags & TagBit(tag)) != 0; }
+    static constexpr TagMask TagBit(TAG tag) { return TagMask{1} << tag; }
 
     template <typename T>
     static constexpr void AddEntity(std::unique_ptr<T>& entity, Entity* parent,
@@ -71,11 +100,18 @@ class Entity {
     }
 
    protected:
-    std::string name;
+    const std::string* name;    // interned, see NameTable
     std::vector<std::unique_ptr<Entity>> childs;
     Entity* parent{nullptr};
-    Transform transform;
-    std::vector<TAG> tags;
+    TransformStore& transforms;
+    TransformStore::Handle transformHandle;
+    TagMask tags{0};
+
+   private:
+    friend class Scene;
+    // index of the entity in the scene's list of every tag it has
+    std::array<uint32_t, TAG_COUNT> tagListPositions{};
+    Scene* taggingScene{nullptr};
 };
 
 }    // namespace XRLib
\ No newline at end of file
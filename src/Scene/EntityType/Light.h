@@ -5,14 +5,36 @@
 namespace XRLib {
 class PointLight : public Entity {
    public:
-    PointLight(Transform transform, glm::vec4 color, float intensity, const std::string& name = "DefaultLight")
-        : color{color}, intensity{intensity}, Entity{transform, name} {}
+    PointLight(TransformStore& transforms, Transform transform, glm::vec4 color, float intensity,
+               const std::string& name = "DefaultLight")
+        : color{color}, intensity{intensity}, Entity{transforms, transform, name} {}
 
     glm::vec4& GetColor() { return color; }
     float& GetIntensity() { return intensity; }
 
+    // attenuation radius, the light has no effect and is culled beyond it. Follows color and intensity through
+    // DefaultRange until SetRange fixes it
+    float GetRange() const { return automaticRange ? DefaultRange(color, intensity) : range; }
+    void SetRange(float r) {
+        range = r;
+        automaticRange = false;
+    }
+    void SetAutomaticRange() { automaticRange = true; }
+
+    // distance where the default attenuation drops the light below one 8 bit step
+    static float DefaultRange(const glm::vec4& color, float intensity) {
+        constexpr float threshold = 1.0f / 256.0f;
+        float k = intensity * std::max({color.r, color.g, color.b}) / threshold;
+        if (k <= 1.0f) {
+            return 0.0f;
+        }
+        return (-0.09f + std::sqrt(0.09f * 0.09f + 4.0f * 0.032f * (k - 1.0f))) / (2.0f * 0.032f);
+    }
+
    private:
     float intensity;
     glm::vec4 color;
+    float range{0.0f};
+    bool automaticRange{true};
 };
 }    // namespace XRLib
\ No newline at end of file
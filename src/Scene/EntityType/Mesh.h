@@ -2,12 +2,13 @@
 
 #include "Entity.h"
 #include "Graphics/Primitives.h"
+#include "Scene/Material.h"
 #include "Utils/Transform.h"
 
 namespace XRLib {
 class Mesh : public Entity {
    public:
-    Mesh() : Entity{"DefaultMesh"} {}
+    explicit Mesh(TransformStore& transforms) : Entity{transforms, "DefaultMesh"} {}
 
     struct MeshLoadConfig {
         std::string meshPath{""};
@@ -22,25 +23,79 @@ class Mesh : public Entity {
         // Note: Assimp may have issues with preTransformVertices in large scenes.  
         // If you encounter problems with certain indices, consider setting it to false.
         bool preTransformVertices = true;
+
+        // reorders indices and vertices at import for post transform cache, overdraw and vertex fetch
+        bool optimizeMeshes = true;
+
+        // builds simplified index ranges at import, the renderer picks one by projected screen error
+        bool generateLODs = true;
+
+        // splits large meshes into meshlets that are culled on the gpu
+        bool buildMeshlets = true;
     };
 
-    struct TextureData {
-        std::vector<uint8_t> textureData;
-        int textureWidth = 0;
-        int textureHeight = 0;
-        int textureChannels = 0;
+    // one level of detail, a range inside the shared index buffer of the mesh.
+    // error is the simplification deviation in object space units, 0 for the full resolution level
+    struct LOD {
+        uint32_t firstIndex{0};
+        uint32_t indexCount{0};
+        float error{0.0f};
     };
 
+    using TextureData = XRLib::TextureData;
+
     std::vector<Graphics::Primitives::Vertex>& GetVerticies() { return vertices; }
     std::vector<uint16_t>& GetIndices() { return indices; }
+    // cluster of up to 64 vertices and 124 triangles, a range inside the full resolution lod.
+    // Bounds and backface cone are in object space
+    struct Meshlet {
+        glm::vec3 center;
+        float radius;
+        glm::vec3 coneAxis;
+        float coneCutoff;
+        uint32_t firstIndex;
+        uint32_t indexCount;
+    };
 
-    TextureData Diffuse{{255, 255, 255, 255}, 1, 1, 4};
-    TextureData Normal{{128, 128, 255, 255}, 1, 1, 4};
-    TextureData MetallicRoughness{{255, 0, 0, 0}, 1, 1, 4}; // default completely roughness, non metallic
-    TextureData Emissive{{0, 0, 0, 0}, 1, 1, 4};
+    std::vector<LOD>& GetLODs() { return lods; }
+    std::vector<Meshlet>& GetMeshlets() { return meshlets; }
+    // index buffer also holds the simplified levels, so draw the full mesh through this range only
+    LOD GetFullLOD() const {
+        return lods.empty() ? LOD{0, static_cast<uint32_t>(indices.size()), 0.0f} : lods[0];
+    }
+
+    // object space bounds, sphere is used for lod selection and culling, box for vertex quantization
+    const glm::vec3& GetBoundsCenter() const { return boundsCenter; }
+    float GetBoundsRadius() const { return boundsRadius; }
+    const glm::vec3& GetBoundsMin() const { return boundsMin; }
+    const glm::vec3& GetBoundsMax() const { return boundsMax; }
+    void SetBounds(const glm::vec3& min, const glm::vec3& max, const glm::vec3& center, float radius) {
+        boundsMin = min;
+        boundsMax = max;
+        boundsCenter = center;
+        boundsRadius = radius;
+    }
+
+    // shared between meshes of one import that reference the same material
+    Material& GetMaterial() { return *material; }
+    const std::shared_ptr<Material>& GetMaterialPtr() const { return material; }
+    void SetMaterial(std::shared_ptr<Material> newMaterial) { material = std::move(newMaterial); }
+
+    // hidden meshes stay prepared on the gpu and are only skipped when drawing
+    bool IsVisible() const { return visible; }
+    void SetVisible(bool visible) { this->visible = visible; }
 
    private:
+    std::shared_ptr<Material> material{std::make_shared<Material>()};
     std::vector<Graphics::Primitives::Vertex> vertices;
     std::vector<uint16_t> indices;
+    std::vector<LOD> lods;
+    std::vector<Meshlet> meshlets;
+
+    glm::vec3 boundsMin{0.0f};
+    glm::vec3 boundsMax{0.0f};
+    glm::vec3 boundsCenter{0.0f};
+    float boundsRadius{0.0f};
+    bool visible{true};
 };
 }    // namespace XRLib
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "EntityType/Mesh.h"
+#include "Logger.h"
+#include "Utils/BatchMath.h"
+
+namespace XRLib {
+// Many copies of one mesh, stored as a flat array of world matrices instead of one entity per copy.
+// The renderer draws a group with a single instanced draw call of its source mesh.
+class InstanceGroup {
+   public:
+    InstanceGroup(Mesh* mesh, std::span<const Transform> transforms) : mesh{mesh} {
+        this->transforms.resize(transforms.size());
+        for (size_t i = 0; i < transforms.size(); ++i) {
+            this->transforms[i] = transforms[i].GetMatrix();
+        }
+        MarkDirty(0, Size());
+    }
+
+    Mesh* GetMesh() { return mesh; }
+    uint32_t Size() const { return static_cast<uint32_t>(transforms.size()); }
+    const std::vector<glm::mat4>& GetTransforms() const { return transforms; }
+
+    // instance count is fixed after creation, only the values can be updated
+    void UpdateInstances(uint32_t firstInstance, std::span<const Transform> newTransforms) {
+        if (firstInstance + newTransforms.size() > transforms.size()) {
+            LOGGER(LOGGER::WARNING) << "Instance update out of range, ignoring";
+            return;
+        }
+        for (size_t i = 0; i < newTransforms.size(); ++i) {
+            transforms[firstInstance + i] = newTransforms[i].GetMatrix();
+        }
+        MarkDirty(firstInstance, firstInstance + static_cast<uint32_t>(newTransforms.size()));
+    }
+
+    // same as above from translation, rotation and scale arrays of equal length, composed in one batch
+    void UpdateInstances(uint32_t firstInstance, std::span<const glm::vec3> translations,
+                         std::span<const glm::quat> rotations, std::span<const glm::vec3> scales) {
+        if (rotations.size() != translations.size() || scales.size() != translations.size() ||
+            firstInstance + translations.size() > transforms.size()) {
+            LOGGER(LOGGER::WARNING) << "Instance update out of range, ignoring";
+            return;
+        }
+        BatchMath::ComposeTRS(translations.data(), rotations.data(), scales.data(), transforms.data() + firstInstance,
+                              translations.size());
+        MarkDirty(firstInstance, firstInstance + static_cast<uint32_t>(translations.size()));
+    }
+
+    void UpdateInstance(uint32_t instance, const Transform& transform) {
+        UpdateInstances(instance, std::span<const Transform>{&transform, 1});
+    }
+
+    // range of instances [first, second) changed since the renderer uploaded them last
+    bool IsDirty() const { return dirtyBegin < dirtyEnd; }
+    std::pair<uint32_t, uint32_t> DirtyRange() const { return {dirtyBegin, dirtyEnd}; }
+    void ClearDirty() { dirtyBegin = dirtyEnd = 0; }
+
+   private:
+    void MarkDirty(uint32_t begin, uint32_t end) {
+        if (!IsDirty()) {
+            dirtyBegin = begin;
+            dirtyEnd = end;
+            return;
+        }
+        dirtyBegin = std::min(dirtyBegin, begin);
+        dirtyEnd = std::max(dirtyEnd, end);
+    }
+
+   private:
+    Mesh* mesh{nullptr};
+    std::vector<glm::mat4> transforms;
+    uint32_t dirtyBegin{0};
+    uint32_t dirtyEnd{0};
+};
+}    // namespace XRLib
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <pch.h>
+
+namespace XRLib {
+struct TextureData {
+    std::vector<uint8_t> textureData;
+    int textureWidth = 0;
+    int textureHeight = 0;
+    int textureChannels = 0;
+
+    // the 1x1 placeholders below stand in for textures a material does not provide
+    bool IsPlaceholder() const { return textureWidth * textureHeight <= 1; }
+};
+
+// Surface description shared by every mesh that uses it. Imports create one material per aiMaterial, so the
+// renderer uploads its textures once and can sort and batch draws by material.
+class Material {
+   public:
+    Material() = default;
+    explicit Material(const std::string& name) : name{name} {}
+
+    const std::string& GetName() const { return name; }
+    // an emissive texture, or a constant emission through a lit placeholder
+    bool IsEmissive() const {
+        const auto& texel = Emissive.textureData;
+        const bool litPlaceholder = texel.size() >= 3 && (texel[0] != 0 || texel[1] != 0 || texel[2] != 0);
+        return emissiveFactor != glm::vec3(0.0f) && (!Emissive.IsPlaceholder() || litPlaceholder);
+    }
+
+    TextureData Diffuse{{255, 255, 255, 255}, 1, 1, 4};
+    TextureData Normal{{128, 128, 255, 255}, 1, 1, 4};
+    TextureData MetallicRoughness{{255, 0, 0, 0}, 1, 1, 4}; // default completely roughness, non metallic
+    TextureData Emissive{{0, 0, 0, 0}, 1, 1, 4};
+
+    // multiplied with the texture samples
+    glm::vec4 baseColorFactor{1.0f};
+    glm::vec3 emissiveFactor{1.0f};
+    float metallicFactor{1.0f};
+    float roughnessFactor{1.0f};
+    float alphaCutoff{0.5f};
+    bool alphaTest{false};    // fragments with an alpha below alphaCutoff are discarded
+
+   private:
+    std::string name{"DefaultMaterial"};
+};
+}    // namespace XRLib
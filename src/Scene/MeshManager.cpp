@@ -1,12 +1,16 @@
 #include "MeshManager.h"
+#include "Scene.h"
+
+#include <assimp/GltfMaterial.h>
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
 namespace XRLib {
 
-MeshManager::MeshManager(std::vector<Mesh*>& meshesContainer, std::vector<std::unique_ptr<Entity>>& hiearchyRoot)
-    : meshes{meshesContainer}, hiearchyRoot{hiearchyRoot} {}
+MeshManager::MeshManager(std::vector<Mesh*>& meshesContainer, std::vector<std::unique_ptr<Entity>>& hiearchyRoot,
+                         Scene& ownerScene)
+    : meshes{meshesContainer}, hiearchyRoot{hiearchyRoot}, ownerScene{ownerScene} {}
 MeshManager::~MeshManager() {}
 
 glm::mat4 ConvertMatrixToGLM(const aiMatrix4x4& from) {
@@ -21,14 +25,14 @@ void MeshManager::WaitForAllMeshesToLoad() {
     EventSystem::TriggerEvent(Events::XRLIB_EVENT_MESHES_LOADING_FINISHED);
 }
 
-void CreateTempTexture(XRLib::Mesh& newMesh, uint8_t color) {
-    Mesh::TextureData textureData;
+void CreateTempTexture(XRLib::Material& material, uint8_t color) {
+    TextureData textureData;
     textureData.textureChannels = 4;
     textureData.textureHeight = 1;
     textureData.textureWidth = 1;
     textureData.textureData.resize(textureData.textureChannels * textureData.textureHeight * textureData.textureWidth,
                                    color);
-    newMesh.Diffuse = textureData;
+    material.Diffuse = textureData;
 }
 
 void MeshManager::LoadMeshAsync(const Mesh::MeshLoadConfig& loadConfig, Entity* bindPtr, Entity* parent) {
@@ -44,6 +48,10 @@ void MeshManager::LoadMesh(const Mesh::MeshLoadConfig& loadConfig, Entity* bindP
     if (loadConfig.preTransformVertices) {
         processFlags |= aiProcess_PreTransformVertices;
     }
+    if (loadConfig.optimizeMeshes) {
+        // done by meshoptimizer in ProcessMesh, together with overdraw and fetch ordering
+        processFlags &= ~aiProcess_ImproveCacheLocality;
+    }
 
     const aiScene* scene = importer.ReadFile(loadConfig.meshPath, processFlags);
 
@@ -52,7 +60,7 @@ void MeshManager::LoadMesh(const Mesh::MeshLoadConfig& loadConfig, Entity* bindP
     };
 
     auto createMeshPlaceHolder = [&]() -> Mesh* {
-        auto meshPlaceHolder = std::make_unique<Mesh>();
+        auto meshPlaceHolder = ownerScene.Create<Mesh>();
         Mesh* meshPtr = meshPlaceHolder.get();
         bindPtr = meshPtr;
         meshes.push_back(meshPtr);
@@ -73,10 +81,18 @@ void MeshManager::LoadMesh(const Mesh::MeshLoadConfig& loadConfig, Entity* bindP
     }
 
     if (scene->mNumMeshes > 0) {
-        auto entityParent = std::make_unique<Entity>(Util::GetFileNameWithoutExtension(loadConfig.meshPath));
+        auto entityParent = ownerScene.Create<Entity>(Util::GetFileNameWithoutExtension(loadConfig.meshPath));
         bindPtr = entityParent.get();
+        // materials load in parallel with the meshes, each mesh waits only for the one it references
+        std::vector<MaterialFuture> materials(scene->mNumMaterials);
+        for (unsigned int i = 0; i < scene->mNumMaterials; ++i) {
+            materials[i] =
+                std::async(std::launch::async, &MeshManager::LoadMaterial, this, std::ref(loadConfig), scene, i)
+                    .share();
+        }
+
         std::vector<std::future<void>> loadFutures;
-        ProcessNode(scene->mRootNode, scene, loadConfig, entityParent.get(), loadFutures);
+        ProcessNode(scene->mRootNode, scene, loadConfig, entityParent.get(), materials, loadFutures);
         for (auto& future : loadFutures) {
             future.wait();
         }
@@ -95,20 +111,21 @@ void MeshManager::LoadMesh(const Mesh::MeshLoadConfig& loadConfig, Entity* bindP
 }
 
 void MeshManager::ProcessNode(aiNode* node, const aiScene* scene, const Mesh::MeshLoadConfig& meshLoadConfig,
-                              Entity* parent, std::vector<std::future<void>>& loadFutures) {
+                              Entity* parent, const std::vector<MaterialFuture>& materials,
+                              std::vector<std::future<void>>& loadFutures) {
     parent->GetLocalTransform() = ConvertMatrixToGLM(node->mTransformation);
 
     // handles meshes
     for (unsigned int i = 0; i < node->mNumMeshes; ++i) {
         aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
         loadFutures.push_back(std::async(std::launch::async, &MeshManager::ProcessMesh, this, mesh, scene,
-                                         std::ref(meshLoadConfig), parent));
+                                         std::ref(meshLoadConfig), parent, std::cref(materials)));
     }
 
     // handles node, transfer to an entity
     for (unsigned int i = 0; i < node->mNumChildren; ++i) {
-        auto entity = std::make_unique<Entity>(Util::GetFileNameWithoutExtension(meshLoadConfig.meshPath));
-        ProcessNode(node->mChildren[i], scene, meshLoadConfig, entity.get(), loadFutures);
+        auto entity = ownerScene.Create<Entity>(Util::GetFileNameWithoutExtension(meshLoadConfig.meshPath));
+        ProcessNode(node->mChildren[i], scene, meshLoadConfig, entity.get(), materials, loadFutures);
         {
             std::lock_guard<std::mutex> lock(mutex);
             Entity::AddEntity(entity, parent);
@@ -116,10 +133,22 @@ void MeshManager::ProcessNode(aiNode* node, const aiScene* scene, const Mesh::Me
     }
 }
 void MeshManager::ProcessMesh(aiMesh* aiMesh, const aiScene* scene, const Mesh::MeshLoadConfig& meshLoadConfig,
-                              Entity* parent) {
-    auto mesh = std::make_unique<Mesh>();
+                              Entity* parent, const std::vector<MaterialFuture>& materials) {
+    auto mesh = ownerScene.Create<Mesh>();
     LoadMeshVerticesIndices(meshLoadConfig, mesh.get(), aiMesh);
-    LoadMeshTextures(meshLoadConfig, mesh.get(), aiMesh, scene);
+    ComputeBounds(mesh.get());
+    if (meshLoadConfig.optimizeMeshes) {
+        OptimizeIndexOrder(mesh.get());
+    }
+    GenerateLODs(meshLoadConfig, mesh.get());
+    BuildMeshlets(meshLoadConfig, mesh.get());
+    if (meshLoadConfig.optimizeMeshes) {
+        // last, since it remaps the vertices referenced by every lod
+        OptimizeVertexFetch(mesh.get());
+    }
+    if (aiMesh->mMaterialIndex < materials.size()) {
+        mesh->SetMaterial(materials[aiMesh->mMaterialIndex].get());
+    }
     mesh->Rename(aiMesh->mName.C_Str());
 
     {
@@ -155,32 +184,201 @@ void MeshManager::LoadMeshVerticesIndices(const Mesh::MeshLoadConfig& meshLoadCo
     }
 }
 
-void MeshManager::LoadMeshTextures(const Mesh::MeshLoadConfig& meshLoadConfig, Mesh* newMesh, aiMesh* aiMesh,
-                                   const aiScene* scene) {
+void MeshManager::ComputeBounds(Mesh* newMesh) {
+    auto& vertices = newMesh->GetVerticies();
+    if (vertices.empty()) {
+        return;
+    }
+
+    glm::vec3 min = vertices[0].position;
+    glm::vec3 max = vertices[0].position;
+    for (const auto& vertex : vertices) {
+        min = glm::min(min, vertex.position);
+        max = glm::max(max, vertex.position);
+    }
+
+    glm::vec3 center = (min + max) * 0.5f;
+    float radius = 0.0f;
+    for (const auto& vertex : vertices) {
+        radius = std::max(radius, glm::length(vertex.position - center));
+    }
+    newMesh->SetBounds(min, max, center, radius);
+}
+
+void MeshManager::GenerateLODs(const Mesh::MeshLoadConfig& meshLoadConfig, Mesh* newMesh) {
+    auto& vertices = newMesh->GetVerticies();
+    auto& indices = newMesh->GetIndices();
+    auto& lods = newMesh->GetLODs();
+    if (indices.empty()) {
+        return;
+    }
+
+    // full resolution level is always the first range of the index buffer
+    lods.push_back({0, static_cast<uint32_t>(indices.size()), 0.0f});
+    if (!meshLoadConfig.generateLODs) {
+        return;
+    }
+
+    const float* positions = &vertices[0].position.x;
+    const size_t stride = sizeof(Graphics::Primitives::Vertex);
+    // simplifier reports error relative to the mesh extents, scale converts it back to object space
+    const float errorScale = meshopt_simplifyScale(positions, vertices.size(), stride);
+
+    // every level is simplified from the full resolution indices, so errors don't accumulate
+    const std::vector<uint16_t> sourceIndices = indices;
+    std::vector<uint16_t> lodIndices(sourceIndices.size());
+    size_t targetCount = sourceIndices.size();
+    size_t previousCount = sourceIndices.size();
+
+    while (lods.size() < maxLODs) {
+        targetCount = static_cast<size_t>(targetCount * lodReductionRatio) / 3 * 3;
+        if (targetCount < 3) {
+            break;
+        }
+
+        float resultError = 0.0f;
+        size_t lodCount = meshopt_simplify(lodIndices.data(), sourceIndices.data(), sourceIndices.size(), positions,
+                                           vertices.size(), stride, targetCount, lodMaxRelativeError,
+                                           meshopt_SimplifyLockBorder, &resultError);
+
+        if (lodCount == 0 || lodCount > previousCount * lodMinReduction) {
+            break;
+        }
+
+        if (meshLoadConfig.optimizeMeshes) {
+            meshopt_optimizeVertexCache(lodIndices.data(), lodIndices.data(), lodCount, vertices.size());
+        }
+
+        lods.push_back({static_cast<uint32_t>(indices.size()), static_cast<uint32_t>(lodCount),
+                        resultError * errorScale});
+        indices.insert(indices.end(), lodIndices.begin(), lodIndices.begin() + lodCount);
+        previousCount = lodCount;
+    }
+}
+
+void MeshManager::OptimizeIndexOrder(Mesh* newMesh) {
+    auto& vertices = newMesh->GetVerticies();
+    auto& indices = newMesh->GetIndices();
+    if (indices.empty()) {
+        return;
+    }
+
+    meshopt_optimizeVertexCache(indices.data(), indices.data(), indices.size(), vertices.size());
+    meshopt_optimizeOverdraw(indices.data(), indices.data(), indices.size(), &vertices[0].position.x,
+                             vertices.size(), sizeof(Graphics::Primitives::Vertex), overdrawThreshold);
+}
+
+void MeshManager::OptimizeVertexFetch(Mesh* newMesh) {
+    auto& vertices = newMesh->GetVerticies();
+    auto& indices = newMesh->GetIndices();
+    if (indices.empty()) {
+        return;
+    }
+
+    // vertices end up in first use order, unreferenced ones are dropped
+    size_t vertexCount = meshopt_optimizeVertexFetch(vertices.data(), indices.data(), indices.size(), vertices.data(),
+                                                     vertices.size(), sizeof(Graphics::Primitives::Vertex));
+    vertices.resize(vertexCount);
+}
+
+void MeshManager::BuildMeshlets(const Mesh::MeshLoadConfig& meshLoadConfig, Mesh* newMesh) {
+    auto& vertices = newMesh->GetVerticies();
+    auto& indices = newMesh->GetIndices();
+    const Mesh::LOD fullLOD = newMesh->GetFullLOD();
+    if (!meshLoadConfig.buildMeshlets || fullLOD.indexCount / 3 < meshletMinTriangles) {
+        return;
+    }
+
+    std::vector<uint32_t> sourceIndices(indices.begin() + fullLOD.firstIndex,
+                                        indices.begin() + fullLOD.firstIndex + fullLOD.indexCount);
+    const float* positions = &vertices[0].position.x;
+    const size_t stride = sizeof(Graphics::Primitives::Vertex);
+
+    size_t maxMeshlets = meshopt_buildMeshletsBound(sourceIndices.size(), meshletMaxVertices, meshletMaxTriangles);
+    std::vector<meshopt_Meshlet> meshlets(maxMeshlets);
+    std::vector<uint32_t> meshletVertices(maxMeshlets * meshletMaxVertices);
+    std::vector<uint8_t> meshletTriangles(maxMeshlets * meshletMaxTriangles * 3);
+
+    size_t meshletCount = meshopt_buildMeshlets(meshlets.data(), meshletVertices.data(), meshletTriangles.data(),
+                                                sourceIndices.data(), sourceIndices.size(), positions, vertices.size(),
+                                                stride, meshletMaxVertices, meshletMaxTriangles, meshletConeWeight);
+
+    // rewrite the full resolution range in meshlet order, so every meshlet is a contiguous index range
+    uint32_t firstIndex = fullLOD.firstIndex;
+    for (size_t i = 0; i < meshletCount; ++i) {
+        const auto& meshlet = meshlets[i];
+        const uint32_t* localVertices = &meshletVertices[meshlet.vertex_offset];
+        const uint8_t* localTriangles = &meshletTriangles[meshlet.triangle_offset];
+
+        for (size_t j = 0; j < meshlet.triangle_count * 3; ++j) {
+            indices[firstIndex + j] = static_cast<uint16_t>(localVertices[localTriangles[j]]);
+        }
+
+        meshopt_Bounds bounds = meshopt_computeMeshletBounds(localVertices, localTriangles, meshlet.triangle_count,
+                                                             positions, vertices.size(), stride);
+        newMesh->GetMeshlets().push_back({{bounds.center[0], bounds.center[1], bounds.center[2]},
+                                          bounds.radius,
+                                          {bounds.cone_axis[0], bounds.cone_axis[1], bounds.cone_axis[2]},
+                                          bounds.cone_cutoff,
+                                          firstIndex,
+                                          meshlet.triangle_count * 3});
+        firstIndex += meshlet.triangle_count * 3;
+    }
+}
+
+std::shared_ptr<Material> MeshManager::LoadMaterial(const Mesh::MeshLoadConfig& meshLoadConfig, const aiScene* scene,
+                                                   unsigned int materialIndex) {
+    aiMaterial* aiMaterial = scene->mMaterials[materialIndex];
+    auto material = std::make_shared<Material>(aiMaterial->GetName().C_Str());
 
     // get embedded textures
-    LoadEmbeddedTextures(meshLoadConfig, newMesh, aiMesh, scene);
+    LoadEmbeddedTextures(meshLoadConfig, material.get(), aiMaterial, scene);
 
     // get meshloadinfo specified texture
-    LoadSpecifiedTextures(newMesh->Diffuse, meshLoadConfig.diffuseTexturePath);
-    LoadSpecifiedTextures(newMesh->Normal, meshLoadConfig.normalTexturePath);
-    LoadSpecifiedTextures(newMesh->MetallicRoughness, meshLoadConfig.metallicRoughnessTexturePath);
-    LoadSpecifiedTextures(newMesh->Emissive, meshLoadConfig.emissiveTexturePath);
+    LoadSpecifiedTextures(material->Diffuse, meshLoadConfig.diffuseTexturePath);
+    LoadSpecifiedTextures(material->Normal, meshLoadConfig.normalTexturePath);
+    LoadSpecifiedTextures(material->MetallicRoughness, meshLoadConfig.metallicRoughnessTexturePath);
+    LoadSpecifiedTextures(material->Emissive, meshLoadConfig.emissiveTexturePath);
 
     // last fallback, create temporary white texture
-    if (newMesh->Diffuse.textureData.empty()) {
-        CreateTempTexture(*newMesh, 255);
+    if (material->Diffuse.textureData.empty()) {
+        CreateTempTexture(*material, 255);
     }
-}
 
-void MeshManager::LoadEmbeddedTextures(const Mesh::MeshLoadConfig& meshLoadConfig, Mesh* newMesh, aiMesh* aiMesh,
-                                       const aiScene* scene) {
-    if (aiMesh->mMaterialIndex < 0) {
-        return;
+    // pbr factors, formats without them keep the neutral defaults
+    aiColor4D baseColor;
+    if (aiMaterial->Get(AI_MATKEY_BASE_COLOR, baseColor) == AI_SUCCESS) {
+        material->baseColorFactor = {baseColor.r, baseColor.g, baseColor.b, baseColor.a};
+    }
+    aiMaterial->Get(AI_MATKEY_METALLIC_FACTOR, material->metallicFactor);
+    aiMaterial->Get(AI_MATKEY_ROUGHNESS_FACTOR, material->roughnessFactor);
+    aiColor3D emissive;
+    if (aiMaterial->Get(AI_MATKEY_COLOR_EMISSIVE, emissive) == AI_SUCCESS) {
+        material->emissiveFactor = {emissive.r, emissive.g, emissive.b};
     }
-    aiMaterial* material = scene->mMaterials[aiMesh->mMaterialIndex];
+    float emissiveStrength = 1.0f;
+    if (aiMaterial->Get(AI_MATKEY_EMISSIVE_INTENSITY, emissiveStrength) == AI_SUCCESS) {
+        material->emissiveFactor *= emissiveStrength;
+    }
+    // a constant emission without a texture, the factor scales a white texel
+    if (material->Emissive.IsPlaceholder() && material->emissiveFactor != glm::vec3(0.0f)) {
+        material->Emissive = {{255, 255, 255, 255}, 1, 1, 4};
+    }
+
+    // gltf alpha mask, blended materials are still drawn opaque
+    aiString alphaMode;
+    if (aiMaterial->Get(AI_MATKEY_GLTF_ALPHAMODE, alphaMode) == AI_SUCCESS) {
+        material->alphaTest = std::string_view{alphaMode.C_Str()} == "MASK";
+    }
+    aiMaterial->Get(AI_MATKEY_GLTF_ALPHACUTOFF, material->alphaCutoff);
+
+    return material;
+}
+
+void MeshManager::LoadEmbeddedTextures(const Mesh::MeshLoadConfig& meshLoadConfig, Material* newMaterial,
+                                       aiMaterial* material, const aiScene* scene) {
     aiString texturePath;
-    auto loadTextureFromEmbedding = [](const aiTexture* texture, Mesh::TextureData& textureData) {
+    auto loadTextureFromEmbedding = [](const aiTexture* texture, TextureData& textureData) {
         if (texture->mHeight == 0) {
             // Compressed texture data
             textureData.textureData.resize(texture->mWidth);
@@ -218,14 +416,14 @@ void MeshManager::LoadEmbeddedTextures(const Mesh::MeshLoadConfig& meshLoadConfi
     if (material->GetTexture(aiTextureType_DIFFUSE, 0, &texturePath) == AI_SUCCESS) {
         const aiTexture* embeddedTexture = scene->GetEmbeddedTexture(texturePath.C_Str());
         if (embeddedTexture) {
-            newMesh->Diffuse.textureData.clear();
-            loadTextureFromEmbedding(embeddedTexture, newMesh->Diffuse);
+            newMaterial->Diffuse.textureData.clear();
+            loadTextureFromEmbedding(embeddedTexture, newMaterial->Diffuse);
         } else {
             auto path = std::filesystem::path(meshLoadConfig.meshPath).parent_path() /
                         std::filesystem::path(texturePath.C_Str());
             if (std::filesystem::is_regular_file(path)) {
-                newMesh->Diffuse.textureData.clear();
-                LoadSpecifiedTextures(newMesh->Diffuse, path.generic_string());
+                newMaterial->Diffuse.textureData.clear();
+                LoadSpecifiedTextures(newMaterial->Diffuse, path.generic_string());
             }
         }
     }
@@ -235,14 +433,14 @@ void MeshManager::LoadEmbeddedTextures(const Mesh::MeshLoadConfig& meshLoadConfi
         material->GetTexture(aiTextureType_HEIGHT, 0, &texturePath) == AI_SUCCESS) {
         const aiTexture* embeddedTexture = scene->GetEmbeddedTexture(texturePath.C_Str());
         if (embeddedTexture) {
-            newMesh->Normal.textureData.clear();
-            loadTextureFromEmbedding(embeddedTexture, newMesh->Normal);
+            newMaterial->Normal.textureData.clear();
+            loadTextureFromEmbedding(embeddedTexture, newMaterial->Normal);
         } else {
             auto path = std::filesystem::path(meshLoadConfig.meshPath).parent_path() /
                         std::filesystem::path(texturePath.C_Str());
             if (std::filesystem::is_regular_file(path)) {
-                newMesh->Normal.textureData.clear();
-                LoadSpecifiedTextures(newMesh->Normal, path.generic_string());
+                newMaterial->Normal.textureData.clear();
+                LoadSpecifiedTextures(newMaterial->Normal, path.generic_string());
             }
         }
     }
@@ -251,14 +449,14 @@ void MeshManager::LoadEmbeddedTextures(const Mesh::MeshLoadConfig& meshLoadConfi
     if (material->GetTexture(aiTextureType_EMISSIVE, 0, &texturePath) == AI_SUCCESS) {
         const aiTexture* embeddedTexture = scene->GetEmbeddedTexture(texturePath.C_Str());
         if (embeddedTexture) {
-            newMesh->Emissive.textureData.clear();
-            loadTextureFromEmbedding(embeddedTexture, newMesh->Emissive);
+            newMaterial->Emissive.textureData.clear();
+            loadTextureFromEmbedding(embeddedTexture, newMaterial->Emissive);
         } else {
             auto path = std::filesystem::path(meshLoadConfig.meshPath).parent_path() /
                         std::filesystem::path(texturePath.C_Str());
             if (std::filesystem::is_regular_file(path)) {
-                newMesh->Emissive.textureData.clear();
-                LoadSpecifiedTextures(newMesh->Emissive, path.generic_string());
+                newMaterial->Emissive.textureData.clear();
+                LoadSpecifiedTextures(newMaterial->Emissive, path.generic_string());
             }
         }
     }
@@ -267,20 +465,20 @@ void MeshManager::LoadEmbeddedTextures(const Mesh::MeshLoadConfig& meshLoadConfi
     if (material->GetTexture(aiTextureType_UNKNOWN, 0, &texturePath) == AI_SUCCESS) {
         const aiTexture* embeddedTexture = scene->GetEmbeddedTexture(texturePath.C_Str());
         if (embeddedTexture) {
-            newMesh->MetallicRoughness.textureData.clear();
-            loadTextureFromEmbedding(embeddedTexture, newMesh->MetallicRoughness);
+            newMaterial->MetallicRoughness.textureData.clear();
+            loadTextureFromEmbedding(embeddedTexture, newMaterial->MetallicRoughness);
         } else {
             auto path = std::filesystem::path(meshLoadConfig.meshPath).parent_path() /
                         std::filesystem::path(texturePath.C_Str());
             if (std::filesystem::is_regular_file(path)) {
-                newMesh->MetallicRoughness.textureData.clear();
-                LoadSpecifiedTextures(newMesh->MetallicRoughness, path.generic_string());
+                newMaterial->MetallicRoughness.textureData.clear();
+                LoadSpecifiedTextures(newMaterial->MetallicRoughness, path.generic_string());
             }
         }
     }
 }
 
-void MeshManager::LoadSpecifiedTextures(Mesh::TextureData& texture, const std::string& path) {
+void MeshManager::LoadSpecifiedTextures(TextureData& texture, const std::string& path) {
     if (path.empty()) {
         return;
     }
@@ -307,7 +505,7 @@ void MeshManager::HandleInvalidMesh(const Mesh::MeshLoadConfig& meshLoadConfig,
     Transform transform;
     newMesh->GetLocalTransform() = transform;
     newMesh->Rename(meshLoadConfig.meshPath);
-    CreateTempTexture(*newMesh, 255);
+    CreateTempTexture(newMesh->GetMaterial(), 255);
 }
 
 }    // namespace XRLib
@@ -7,9 +7,13 @@
 #include "Utils/Util.h"
 
 namespace XRLib {
+class Scene;
+
 class MeshManager {
    public:
-    MeshManager(std::vector<Mesh*>& meshesContainer, std::vector<std::unique_ptr<Entity>>& hiearchyRoot);
+    // entities are created through the scene, which owns their memory
+    MeshManager(std::vector<Mesh*>& meshesContainer, std::vector<std::unique_ptr<Entity>>& hiearchyRoot,
+                Scene& ownerScene);
     ~MeshManager();
     void WaitForAllMeshesToLoad();
     void LoadMeshAsync(const Mesh::MeshLoadConfig& loadConfig, Entity* bindPtr, Entity* parent = nullptr);
@@ -18,18 +22,42 @@ class MeshManager {
    private:
     void LoadMesh(const Mesh::MeshLoadConfig& loadConfig, Entity* bindPtr, Entity* parent);
     void LoadMeshVerticesIndices(const Mesh::MeshLoadConfig& meshLoadConfig, Mesh* newMesh, aiMesh* aiMesh);
-    void LoadMeshTextures(const Mesh::MeshLoadConfig& meshLoadConfig, Mesh* newMesh, aiMesh* aiMesh, const aiScene* scene);
-    void LoadEmbeddedTextures(const Mesh::MeshLoadConfig& meshLoadConfig, Mesh* newMesh, aiMesh* aiMesh, const aiScene* scene);
-    void LoadSpecifiedTextures(Mesh::TextureData& texture, const std::string& path);
+    std::shared_ptr<Material> LoadMaterial(const Mesh::MeshLoadConfig& meshLoadConfig, const aiScene* scene,
+                                           unsigned int materialIndex);
+    void LoadEmbeddedTextures(const Mesh::MeshLoadConfig& meshLoadConfig, Material* newMaterial, aiMaterial* material,
+                              const aiScene* scene);
+    void LoadSpecifiedTextures(TextureData& texture, const std::string& path);
+    void ComputeBounds(Mesh* newMesh);
+    void GenerateLODs(const Mesh::MeshLoadConfig& meshLoadConfig, Mesh* newMesh);
+    void OptimizeIndexOrder(Mesh* newMesh);
+    void OptimizeVertexFetch(Mesh* newMesh);
+    void BuildMeshlets(const Mesh::MeshLoadConfig& meshLoadConfig, Mesh* newMesh);
 
-    void ProcessNode(aiNode* node, const aiScene* scene, const Mesh::MeshLoadConfig& meshLoadConfig, Entity* parent, std::vector<std::future<void>>& loadFutures);
-    void ProcessMesh(aiMesh* aiMesh, const aiScene* scene, const Mesh::MeshLoadConfig& meshLoadConfig, Entity* parent);
+    using MaterialFuture = std::shared_future<std::shared_ptr<Material>>;
+    void ProcessNode(aiNode* node, const aiScene* scene, const Mesh::MeshLoadConfig& meshLoadConfig, Entity* parent,
+                     const std::vector<MaterialFuture>& materials, std::vector<std::future<void>>& loadFutures);
+    void ProcessMesh(aiMesh* aiMesh, const aiScene* scene, const Mesh::MeshLoadConfig& meshLoadConfig, Entity* parent,
+                     const std::vector<MaterialFuture>& materials);
 
     void HandleInvalidMesh(const Mesh::MeshLoadConfig& meshLoadConfig, Mesh* newMesh);
 
    private:
+    // simplification stops after this many levels or once a level no longer shrinks noticeably
+    inline constexpr static uint32_t maxLODs = 6;
+    inline constexpr static float lodReductionRatio = 0.5f;
+    inline constexpr static float lodMinReduction = 0.8f;
+    inline constexpr static float lodMaxRelativeError = 0.1f;
+    // allowed vertex cache efficiency loss when reordering triangles for less overdraw
+    inline constexpr static float overdrawThreshold = 1.05f;
+    // meshlet sizes that suit common gpu wave sizes, small meshes are culled as a whole instead
+    inline constexpr static size_t meshletMaxVertices = 64;
+    inline constexpr static size_t meshletMaxTriangles = 124;
+    inline constexpr static float meshletConeWeight = 0.25f;
+    inline constexpr static size_t meshletMinTriangles = 4096;
+
     std::vector<Mesh*>& meshes;
     std::vector<std::unique_ptr<Entity>>& hiearchyRoot;
+    Scene& ownerScene;
 
     // synchronization
     std::vector<std::future<void>> futures;
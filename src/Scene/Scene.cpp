@@ -17,8 +17,8 @@ Scene::Scene() {
     EventSystem::RegisterListener(Events::XRLIB_EVENT_APPLICATION_INIT_STARTED, allMeshesLoadCallback);
 }
 void Scene::AddMandatoryMainCamera() {
-    auto camera = std::make_unique<Camera>();
-    camera->Tags().push_back(Entity::TAG::MAIN_CAMERA);
+    auto camera = Create<Camera>();
+    AddTag(camera.get(), Entity::TAG::MAIN_CAMERA);
     cam = camera.get();
     sceneHierarchy.push_back(std::move(camera));
 }
@@ -26,28 +26,63 @@ void Scene::AddMandatoryMainCamera() {
 Scene& Scene::LoadMeshAsync(Mesh::MeshLoadConfig loadConfig, Entity* parent) {
     Entity* _ = nullptr;
     meshManager.LoadMeshAsync(loadConfig, _, parent);
+    MarkChanged();
     return *this;
 }
 
 Scene& Scene::LoadMeshAsyncWithBinding(Mesh::MeshLoadConfig loadConfig, Entity*& bindPtr, Entity* parent) {
     meshManager.LoadMeshAsync(loadConfig, bindPtr, parent);
+    MarkChanged();
     return *this;
 }
 
 void Scene::Validate() {
-    for (auto& mesh : meshes) {
-        if (Util::VectorContains(mesh->Tags(), Mesh::TAG::MESH_LEFT_CONTROLLER) &&
-            Util::VectorContains(mesh->Tags(), Mesh::TAG::MESH_RIGHT_CONTROLLER)) {
+    for (auto entity : EntitiesWithTag(Entity::TAG::MESH_LEFT_CONTROLLER)) {
+        if (entity->HasTag(Entity::TAG::MESH_RIGHT_CONTROLLER)) {
             Util::ErrorPopup("Mesh can't be left and right controller and the same time");
         }
     }
 }
 
+void Scene::AddTag(Entity* entity, Entity::TAG tag) {
+    if (entity->HasTag(tag)) {
+        return;
+    }
+    entity->tags |= Entity::TagBit(tag);
+    entity->taggingScene = this;
+    entity->tagListPositions[tag] = static_cast<uint32_t>(taggedEntities[tag].size());
+    taggedEntities[tag].push_back(entity);
+}
+
+void Scene::RemoveTag(Entity* entity, Entity::TAG tag) {
+    if (!entity->HasTag(tag)) {
+        return;
+    }
+    // the last entity of the list takes the removed one's place
+    auto& entities = taggedEntities[tag];
+    const uint32_t position = entity->tagListPositions[tag];
+    entities[position] = entities.back();
+    entities[position]->tagListPositions[tag] = position;
+    entities.pop_back();
+    entity->tags &= ~Entity::TagBit(tag);
+}
+
+void* Scene::AllocateNode(size_t size, size_t alignment) {
+    std::lock_guard<std::mutex> lock(nodeArenaMutex);
+    return nodeArena.allocate(size, alignment);
+}
+
+void Scene::RemoveTags(Entity* entity) {
+    for (int tag = 0; tag < Entity::TAG_COUNT; ++tag) {
+        RemoveTag(entity, static_cast<Entity::TAG>(tag));
+    }
+}
+
 Scene& Scene::AttachEntityToLeftControllerPose(Entity*& entity) {
     EventSystem::Callback<> tagCallback = [this, &entity] (){
         if (entity == nullptr)
             return;
-        entity->Tags().push_back(Entity::TAG::MESH_LEFT_CONTROLLER);
+        AddTag(entity, Entity::TAG::MESH_LEFT_CONTROLLER);
     };
     EventSystem::RegisterListener(Events::XRLIB_EVENT_MESHES_LOADING_FINISHED, tagCallback);
 
@@ -65,7 +100,7 @@ Scene& Scene::AttachEntityToRightcontrollerPose(Entity*& entity) {
     EventSystem::Callback<> tagCallback = [this, &entity] (){
         if (entity == nullptr)
             return;
-        entity->Tags().push_back(Entity::TAG::MESH_RIGHT_CONTROLLER);
+        AddTag(entity, Entity::TAG::MESH_RIGHT_CONTROLLER);
     };
     EventSystem::RegisterListener(Events::XRLIB_EVENT_MESHES_LOADING_FINISHED, tagCallback);
 
@@ -87,7 +122,7 @@ Scene& Scene::AddPointLights(Transform transform, glm::vec4 color, float intensi
 
 Scene& Scene::AddPointLightsWithBinding(Transform transform, glm::vec4 color, float intensity, Entity*& bindPtr,
                                         Entity* parent) {
-    auto light = std::make_unique<PointLight>(transform, color, intensity);
+    auto light = Create<PointLight>(transform, color, intensity);
     bindPtr = light.get();
     AddPointLightsInternal(light, parent);
     return *this;
@@ -101,7 +136,7 @@ Scene& Scene::AddPointLights(Transform transform, glm::vec4 color, float intensi
 
 Scene& Scene::AddPointLightsWithBinding(Transform transform, glm::vec4 color, float intensity, std::string name,
                                         Entity*& bindPtr, Entity* parent) {
-    auto light = std::make_unique<PointLight>(transform, color, intensity, name);
+    auto light = Create<PointLight>(transform, color, intensity, name);
     bindPtr = light.get();
     AddPointLightsInternal(light, parent);
     return *this;
@@ -113,6 +148,7 @@ void Scene::AddPointLightsInternal(std::unique_ptr<PointLight>& light, Entity* p
     } else {
         Entity::AddEntity(light, parent, &pointLights);
     }
+    MarkChanged();
 }
 
 Scene& Scene::AddEntity(Transform transform, std::string name, Entity* parent) {
@@ -122,13 +158,33 @@ Scene& Scene::AddEntity(Transform transform, std::string name, Entity* parent) {
 }
 
 Scene& Scene::AddEntityWithBinding(Transform transform, std::string name, Entity*& bindPtr, Entity* parent) {
-    auto entity = std::make_unique<Entity>(transform, name);
+    auto entity = Create<Entity>(transform, name);
     bindPtr = entity.get();
     if (parent == nullptr)
         Entity::AddEntity(entity, sceneHierarchy);
     else {
         Entity::AddEntity(entity, parent);
     }
+    MarkChanged();
+    return *this;
+}
+
+Scene& Scene::AddInstances(Mesh* mesh, std::span<const Transform> transforms) {
+    InstanceGroup* _ = nullptr;
+    AddInstancesWithBinding(mesh, transforms, _);
+    return *this;
+}
+
+Scene& Scene::AddInstancesWithBinding(Mesh* mesh, std::span<const Transform> transforms, InstanceGroup*& bindPtr) {
+    if (mesh == nullptr || transforms.empty()) {
+        LOGGER(LOGGER::WARNING) << "Adding instances without mesh or transforms, skipping";
+        bindPtr = nullptr;
+        return *this;
+    }
+    auto instanceGroup = std::make_unique<InstanceGroup>(mesh, transforms);
+    bindPtr = instanceGroup.get();
+    instanceGroups.push_back(std::move(instanceGroup));
+    MarkChanged();
     return *this;
 }
 
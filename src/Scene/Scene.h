@@ -7,6 +7,7 @@
 #include "EntityType/Camera.h"
 #include "EntityType/Entity.h"
 #include "EntityType/Light.h"
+#include "InstanceGroup.h"
 #include "MeshManager.h"
 
 namespace XRLib {
@@ -42,23 +43,67 @@ class Scene {
 
     std::vector<PointLight*>& PointLights() { return pointLights; }
 
+    // Instance groups have to be added before the renderer is prepared, their transforms (world space) can be
+    // updated at any time through InstanceGroup::UpdateInstances
+    Scene& AddInstances(Mesh* mesh, std::span<const Transform> transforms);
+    Scene& AddInstancesWithBinding(Mesh* mesh, std::span<const Transform> transforms, InstanceGroup*& bindPtr);
+
+    std::vector<std::unique_ptr<InstanceGroup>>& InstanceGroups() { return instanceGroups; }
+
     Camera*& MainCamera() { return cam; }
 
+    // creates an entity in the node arena of this scene, args are the constructor arguments after the transform
+    // store, which the scene passes itself. Thread safe, the entity still has to be added to the hierarchy
+    template <typename T, typename... Args>
+    std::unique_ptr<T> Create(Args&&... args) {
+        static_assert(std::is_base_of<Entity, T>::value, "T must be a child of Entity");
+        return std::unique_ptr<T>(new (*this) T(transforms, std::forward<Args>(args)...));
+    }
+
+    // the per tag lists are dense and unordered, so queries and tag changes don't depend on the entity count
+    void AddTag(Entity* entity, Entity::TAG tag);
+    void RemoveTag(Entity* entity, Entity::TAG tag);
+    const std::vector<Entity*>& EntitiesWithTag(Entity::TAG tag) const { return taggedEntities[tag]; }
+
+    // bumped by every structural change, renderers that cache recorded commands compare it between frames.
+    // Changes the scene can't see, such as edited materials, have to be announced with MarkChanged
+    uint64_t Generation() const { return generation; }
+    void MarkChanged() { ++generation; }
+
     const std::vector<std::unique_ptr<Entity>>& GetHiearchy() const { return sceneHierarchy; }
 
+    // store of every entity transform of this scene, entities created for the scene allocate from it
+    TransformStore& Transforms() { return transforms; }
+    // propagates every world matrix in one sweep of the transform store, read back with Entity::GetWorldMatrix
+    void UpdateTransforms() { transforms.Propagate(); }
+
    private:
+    friend class Entity;
+    // called by destroyed entities
+    void RemoveTags(Entity* entity);
+    // memory of created entities, see Entity::operator new
+    void* AllocateNode(size_t size, size_t alignment);
     void AddPointLightsInternal(std::unique_ptr<PointLight>& light, Entity* parent);
     void AddMandatoryMainCamera();
 
    private:
+    // declared first, entities free their transforms and leave the tag lists when the hierarchy is destroyed.
+    // The arena never reuses the memory of destroyed entities, it is released with the scene
+    inline constexpr static size_t nodeArenaChunkSize = 64 * 1024;
+    std::pmr::monotonic_buffer_resource nodeArena{nodeArenaChunkSize};
+    std::mutex nodeArenaMutex;
+    TransformStore transforms;
+    std::array<std::vector<Entity*>, Entity::TAG_COUNT> taggedEntities;
     std::vector<std::unique_ptr<Entity>> sceneHierarchy;
 
     // store rendering required components along side the scene hiearchy
     std::vector<PointLight*> pointLights;
     std::vector<Mesh*> meshes;
+    std::vector<std::unique_ptr<InstanceGroup>> instanceGroups;
     Camera* cam = nullptr;
+    uint64_t generation{0};
 
-    MeshManager meshManager{meshes, sceneHierarchy};
+    MeshManager meshManager{meshes, sceneHierarchy, *this};
 };
 
 inline void buildTreeStr(Entity* node, std::ostringstream& oss, const std::string& prefix = "", bool isLast = true) {
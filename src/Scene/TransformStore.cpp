@@ -0,0 +1,169 @@
+#include "TransformStore.h"
+#include "Utils/BatchMath.h"
+#include "Utils/Util.h"
+
+namespace XRLib {
+TransformStore::Handle TransformStore::Allocate(const Transform& local) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Handle handle;
+    if (!freeHandles.empty()) {
+        handle = freeHandles.back();
+        freeHandles.pop_back();
+    } else {
+        if (handleCount == pageSize * maxPages) {
+            Util::ErrorPopup("Transform store is full");
+        }
+        handle = handleCount++;
+        if (pages[handle / pageSize] == nullptr) {
+            pages[handle / pageSize] = std::make_unique<Page>();
+        }
+    }
+
+    auto& slot = GetSlot(handle);
+    slot.local = local;
+    slot.parent = invalidHandle;
+    slot.position = invalidPosition;
+    slot.alive = true;
+    orderDirty = true;
+    return handle;
+}
+
+void TransformStore::Free(Handle handle) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& slot = GetSlot(handle);
+    slot.alive = false;
+    slot.parent = invalidHandle;
+    slot.position = invalidPosition;
+    freeHandles.push_back(handle);
+    orderDirty = true;
+}
+
+void TransformStore::SetParent(Handle handle, Handle parent) {
+    std::lock_guard<std::mutex> lock(mutex);
+    GetSlot(handle).parent = parent;
+    orderDirty = true;
+}
+
+glm::mat4 TransformStore::ComputeWorld(Handle handle) {
+    glm::mat4 world = GetSlot(handle).local.GetMatrix();
+    for (Handle parent = GetSlot(handle).parent; parent != invalidHandle; parent = GetSlot(parent).parent) {
+        world = GetSlot(parent).local.GetMatrix() * world;
+    }
+    return world;
+}
+
+glm::mat4 TransformStore::World(Handle handle) {
+    const uint32_t position = GetSlot(handle).position;
+    return position == invalidPosition ? ComputeWorld(handle) : worlds[position];
+}
+
+void TransformStore::Propagate() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (orderDirty) {
+        RebuildOrder();
+    }
+
+    if (order.size() < parallelPropagateThreshold || chunkFirstSegments.size() < 2) {
+        Sweep(0, order.size());
+        return;
+    }
+
+    // the roots first, then the subtrees below them are independent of each other
+    for (uint32_t root : rootPositions) {
+        Sweep(root, root + 1);
+    }
+    if (workers == nullptr) {
+        workers = std::make_unique<WorkerPool>(std::max(1u, std::thread::hardware_concurrency()) - 1);
+    }
+    workers->Run(chunkFirstSegments.size(), [this](size_t chunk) {
+        const size_t lastSegment =
+            chunk + 1 < chunkFirstSegments.size() ? chunkFirstSegments[chunk + 1] : segments.size();
+        for (size_t segment = chunkFirstSegments[chunk]; segment < lastSegment; ++segment) {
+            Sweep(segments[segment].first, segments[segment].second);
+        }
+    });
+}
+
+void TransformStore::Sweep(size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+        orderLocals[i] = GetSlot(order[i]).local.GetMatrix();
+    }
+    BatchMath::PropagateHierarchy(orderLocals.data(), orderParents.data(), worlds.data(), begin, end);
+}
+
+void TransformStore::RebuildOrder() {
+    // children of every handle as one counting sorted array, then an iterative depth first walk from the roots
+    std::vector<uint32_t> childBegin(handleCount + 1, 0);
+    for (Handle handle = 0; handle < handleCount; ++handle) {
+        const auto& slot = GetSlot(handle);
+        if (slot.alive && slot.parent != invalidHandle) {
+            ++childBegin[slot.parent + 1];
+        }
+    }
+    for (Handle handle = 0; handle < handleCount; ++handle) {
+        childBegin[handle + 1] += childBegin[handle];
+    }
+    std::vector<Handle> children(childBegin[handleCount]);
+    std::vector<uint32_t> childFill(childBegin.begin(), childBegin.end() - 1);
+    for (Handle handle = 0; handle < handleCount; ++handle) {
+        const auto& slot = GetSlot(handle);
+        if (slot.alive && slot.parent != invalidHandle) {
+            children[childFill[slot.parent]++] = handle;
+        }
+    }
+
+    order.clear();
+    orderParents.clear();
+    rootPositions.clear();
+    std::vector<Handle> stack;
+    for (Handle root = 0; root < handleCount; ++root) {
+        const auto& rootSlot = GetSlot(root);
+        if (!rootSlot.alive || rootSlot.parent != invalidHandle) {
+            continue;
+        }
+        rootPositions.push_back(static_cast<uint32_t>(order.size()));
+        stack.push_back(root);
+        while (!stack.empty()) {
+            const Handle handle = stack.back();
+            stack.pop_back();
+            auto& slot = GetSlot(handle);
+            slot.position = static_cast<uint32_t>(order.size());
+            order.push_back(handle);
+            const Handle parent = slot.parent;
+            orderParents.push_back(parent == invalidHandle ? BatchMath::rootParent : GetSlot(parent).position);
+            // reversed, so children keep their creation order
+            for (uint32_t c = childBegin[handle + 1]; c > childBegin[handle]; --c) {
+                stack.push_back(children[c - 1]);
+            }
+        }
+    }
+    orderLocals.resize(order.size());
+    worlds.resize(order.size());
+
+    // a segment starts at every child of a root and ends at the next one or the next root
+    segments.clear();
+    size_t nextRoot = 0;
+    for (uint32_t i = 0; i < order.size(); ++i) {
+        if (nextRoot < rootPositions.size() && rootPositions[nextRoot] == i) {
+            ++nextRoot;
+        } else if (orderParents[orderParents[i]] == BatchMath::rootParent) {
+            segments.push_back({i, i + 1});
+        } else {
+            // deeper entries follow the child of the root they descend from
+            ++segments.back().second;
+        }
+    }
+
+    const size_t chunkCount = std::max(1u, std::thread::hardware_concurrency());
+    const size_t transformsPerChunk = (order.size() + chunkCount - 1) / chunkCount;
+    chunkFirstSegments.clear();
+    for (uint32_t segment = 0; segment < segments.size();) {
+        chunkFirstSegments.push_back(segment);
+        const uint32_t chunkBegin = segments[segment].first;
+        do {
+            ++segment;
+        } while (segment < segments.size() && segments[segment].second - chunkBegin <= transformsPerChunk);
+    }
+    orderDirty = false;
+}
+}    // namespace XRLib
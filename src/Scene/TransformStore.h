@@ -0,0 +1,78 @@
+#pragma once
+
+#include "Utils/Transform.h"
+#include "Utils/WorkerPool.h"
+
+namespace XRLib {
+// Transforms of the entities of one scene in flat arrays, entities only keep a handle into it. Every scene owns its
+// store, so Propagate only sweeps the entities of the scene it updates.
+// Local transforms and parents live in fixed pages at their handle for the entity's lifetime, so references to a
+// local transform stay valid while other entities are created. World matrices are kept in depth first order with
+// every parent before its children, so Propagate is one linear sweep instead of a recursive walk per entity.
+// Creating, destroying and reparenting entities is thread safe, reading and Propagate belong to the thread that
+// updates the scene.
+class TransformStore {
+   public:
+    using Handle = uint32_t;
+    inline constexpr static Handle invalidHandle = UINT32_MAX;
+
+    inline constexpr static uint32_t pageSize = 4096;
+    inline constexpr static uint32_t maxPages = 1024;
+    // fewer transforms are propagated on the calling thread. The parallel sweep splits below the roots, so a big
+    // import under a single root is spread over the workers too
+    inline constexpr static size_t parallelPropagateThreshold = 16384;
+
+    Handle Allocate(const Transform& local);
+    void Free(Handle handle);
+    void SetParent(Handle handle, Handle parent);
+
+    Transform& Local(Handle handle) { return GetSlot(handle).local; }
+    Handle Parent(Handle handle) { return GetSlot(handle).parent; }
+    // walks the parent chain, always reflects the latest local transforms
+    glm::mat4 ComputeWorld(Handle handle);
+    // world matrix as of the last Propagate, computed on the spot for entities created since
+    glm::mat4 World(Handle handle);
+
+    // recomputes every world matrix, the depth first order is rebuilt first if the hierarchy changed
+    void Propagate();
+
+   private:
+    inline constexpr static uint32_t invalidPosition = UINT32_MAX;
+
+    struct Slot {
+        Transform local;
+        Handle parent{invalidHandle};
+        uint32_t position{invalidPosition};    // index into the depth first arrays
+        bool alive{false};
+    };
+    struct Page {
+        std::array<Slot, pageSize> slots;
+    };
+
+    Slot& GetSlot(Handle handle) { return pages[handle / pageSize]->slots[handle % pageSize]; }
+    void RebuildOrder();
+    // sweeps the given range in depth first order, every parent outside of it has to be computed already
+    void Sweep(size_t begin, size_t end);
+
+   private:
+    std::array<std::unique_ptr<Page>, maxPages> pages;
+    Handle handleCount{0};
+    std::vector<Handle> freeHandles;
+
+    // depth first order: handle and parent position per entry, roots start the contiguous ranges of their subtrees
+    std::vector<Handle> order;
+    std::vector<uint32_t> orderParents;
+    std::vector<glm::mat4> orderLocals;    // gathered from the slots before every sweep
+    std::vector<glm::mat4> worlds;
+    std::vector<uint32_t> rootPositions;
+    // subtrees of the children of the roots as [begin, end) ranges, independent once the roots are computed
+    std::vector<std::pair<uint32_t, uint32_t>> segments;
+    // first segment of every parallel chunk, chunks hold roughly equal transform counts
+    std::vector<uint32_t> chunkFirstSegments;
+    // created with the first parallel sweep, the calling thread sweeps too so it holds one thread less
+    std::unique_ptr<WorkerPool> workers;
+    bool orderDirty{true};
+
+    std::mutex mutex;
+};
+}    // namespace XRLib
@@ -0,0 +1,474 @@
+#include "BatchMath.h"
+#include "Logger.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+    #define XRLIB_BATCHMATH_X64
+    #include <immintrin.h>
+    #if defined(_MSC_VER) && !defined(__clang__)
+        #include <intrin.h>
+        #define XRLIB_TARGET_AVX2
+    #else
+        #define XRLIB_TARGET_AVX2 __attribute__((target("avx2")))
+    #endif
+#endif
+
+namespace XRLib {
+namespace {
+struct Kernels {
+    void (*composeTRS)(const glm::vec3*, const glm::quat*, const glm::vec3*, glm::mat4*, size_t);
+    void (*propagateHierarchy)(const glm::mat4*, const uint32_t*, glm::mat4*, size_t, size_t);
+    void (*inverseTranspose)(const glm::mat4*, glm::mat3x4*, size_t);
+    void (*transformAABBs)(const glm::mat4*, const glm::vec4*, const glm::vec4*, glm::vec4*, glm::vec4*, size_t);
+};
+
+////////////////////////////////////////////////////
+/// Scalar
+////////////////////////////////////////////////////
+// written out instead of glm::translate * glm::mat4_cast * glm::scale, so the remainders of the simd loops
+// compute the exact same operations as their lanes
+glm::mat4 ComposeTRSScalar(const glm::vec3& t, const glm::quat& q, const glm::vec3& s) {
+    const float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+    const float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+    const float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+    glm::mat4 m;
+    m[0] = glm::vec4(glm::vec3(1.0f - 2.0f * (yy + zz), 2.0f * (xy + wz), 2.0f * (xz - wy)) * s.x, 0.0f);
+    m[1] = glm::vec4(glm::vec3(2.0f * (xy - wz), 1.0f - 2.0f * (xx + zz), 2.0f * (yz + wx)) * s.y, 0.0f);
+    m[2] = glm::vec4(glm::vec3(2.0f * (xz + wy), 2.0f * (yz - wx), 1.0f - 2.0f * (xx + yy)) * s.z, 0.0f);
+    m[3] = glm::vec4(t, 1.0f);
+    return m;
+}
+
+glm::mat4 MultiplyScalar(const glm::mat4& a, const glm::mat4& b) {
+    glm::mat4 m;
+    for (int j = 0; j < 4; ++j) {
+        m[j] = a[0] * b[j][0] + a[1] * b[j][1] + a[2] * b[j][2] + a[3] * b[j][3];
+    }
+    return m;
+}
+
+glm::mat3x4 InverseTransposeScalar(const glm::mat4& m) {
+    const glm::vec3 c0{m[0]}, c1{m[1]}, c2{m[2]};
+    const glm::vec3 r0 = glm::cross(c1, c2), r1 = glm::cross(c2, c0), r2 = glm::cross(c0, c1);
+    const float det = glm::dot(c0, r0);
+    const float invDet = det != 0.0f ? 1.0f / det : 1.0f;
+    return {glm::vec4(r0 * invDet, 0.0f), glm::vec4(r1 * invDet, 0.0f), glm::vec4(r2 * invDet, 0.0f)};
+}
+
+void TransformAABBScalar(const glm::mat4& m, const glm::vec4& center, const glm::vec4& extent, glm::vec4& outCenter,
+                         glm::vec4& outExtent) {
+    outCenter = m[0] * center.x + m[1] * center.y + m[2] * center.z + m[3];
+    outExtent = glm::abs(m[0]) * extent.x + glm::abs(m[1]) * extent.y + glm::abs(m[2]) * extent.z;
+}
+
+void ComposeTRSScalarBatch(const glm::vec3* translations, const glm::quat* rotations, const glm::vec3* scales,
+                           glm::mat4* out, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        out[i] = ComposeTRSScalar(translations[i], rotations[i], scales[i]);
+    }
+}
+
+void PropagateHierarchyScalar(const glm::mat4* locals, const uint32_t* parents, glm::mat4* worlds, size_t begin,
+                              size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+        worlds[i] = parents[i] == BatchMath::rootParent ? locals[i] : MultiplyScalar(worlds[parents[i]], locals[i]);
+    }
+}
+
+void InverseTransposeScalarBatch(const glm::mat4* matrices, glm::mat3x4* out, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        out[i] = InverseTransposeScalar(matrices[i]);
+    }
+}
+
+void TransformAABBsScalar(const glm::mat4* matrices, const glm::vec4* centers, const glm::vec4* extents,
+                          glm::vec4* outCenters, glm::vec4* outExtents, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        TransformAABBScalar(matrices[i], centers[i], extents[i], outCenters[i], outExtents[i]);
+    }
+}
+
+constexpr Kernels scalarKernels{ComposeTRSScalarBatch, PropagateHierarchyScalar, InverseTransposeScalarBatch,
+                                TransformAABBsScalar};
+
+#ifdef XRLIB_BATCHMATH_X64
+////////////////////////////////////////////////////
+/// SSE, one matrix per register set, or four entries per lane for trs
+////////////////////////////////////////////////////
+const float* Floats(const glm::mat4& m) { return glm::value_ptr(m); }
+float* Floats(glm::mat4& m) { return glm::value_ptr(m); }
+
+inline void MultiplySSE(const float* a, const float* b, float* out) {
+    const __m128 a0 = _mm_loadu_ps(a), a1 = _mm_loadu_ps(a + 4), a2 = _mm_loadu_ps(a + 8), a3 = _mm_loadu_ps(a + 12);
+    for (int j = 0; j < 4; ++j) {
+        const float* bj = b + 4 * j;
+        __m128 r = _mm_mul_ps(a0, _mm_set1_ps(bj[0]));
+        r = _mm_add_ps(r, _mm_mul_ps(a1, _mm_set1_ps(bj[1])));
+        r = _mm_add_ps(r, _mm_mul_ps(a2, _mm_set1_ps(bj[2])));
+        r = _mm_add_ps(r, _mm_mul_ps(a3, _mm_set1_ps(bj[3])));
+        _mm_storeu_ps(out + 4 * j, r);
+    }
+}
+
+// column of four matrices from the x, y, z, w components of four lanes
+inline void StoreColumnSSE(__m128 x, __m128 y, __m128 z, __m128 w, glm::mat4* out, int column) {
+    _MM_TRANSPOSE4_PS(x, y, z, w);
+    _mm_storeu_ps(glm::value_ptr(out[0][column]), x);
+    _mm_storeu_ps(glm::value_ptr(out[1][column]), y);
+    _mm_storeu_ps(glm::value_ptr(out[2][column]), z);
+    _mm_storeu_ps(glm::value_ptr(out[3][column]), w);
+}
+
+void ComposeTRSSSE(const glm::vec3* translations, const glm::quat* rotations, const glm::vec3* scales,
+                   glm::mat4* out, size_t count) {
+    const __m128 one = _mm_set1_ps(1.0f), two = _mm_set1_ps(2.0f), zero = _mm_setzero_ps();
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const glm::quat* q = rotations + i;
+        const glm::vec3* t = translations + i;
+        const glm::vec3* s = scales + i;
+        const __m128 qx = _mm_set_ps(q[3].x, q[2].x, q[1].x, q[0].x);
+        const __m128 qy = _mm_set_ps(q[3].y, q[2].y, q[1].y, q[0].y);
+        const __m128 qz = _mm_set_ps(q[3].z, q[2].z, q[1].z, q[0].z);
+        const __m128 qw = _mm_set_ps(q[3].w, q[2].w, q[1].w, q[0].w);
+        const __m128 sx = _mm_set_ps(s[3].x, s[2].x, s[1].x, s[0].x);
+        const __m128 sy = _mm_set_ps(s[3].y, s[2].y, s[1].y, s[0].y);
+        const __m128 sz = _mm_set_ps(s[3].z, s[2].z, s[1].z, s[0].z);
+
+        const __m128 xx = _mm_mul_ps(qx, qx), yy = _mm_mul_ps(qy, qy), zz = _mm_mul_ps(qz, qz);
+        const __m128 xy = _mm_mul_ps(qx, qy), xz = _mm_mul_ps(qx, qz), yz = _mm_mul_ps(qy, qz);
+        const __m128 wx = _mm_mul_ps(qw, qx), wy = _mm_mul_ps(qw, qy), wz = _mm_mul_ps(qw, qz);
+
+        auto oneMinusTwice = [&](__m128 a, __m128 b) { return _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(a, b))); };
+        auto twiceSum = [&](__m128 a, __m128 b) { return _mm_mul_ps(two, _mm_add_ps(a, b)); };
+        auto twiceDiff = [&](__m128 a, __m128 b) { return _mm_mul_ps(two, _mm_sub_ps(a, b)); };
+
+        StoreColumnSSE(_mm_mul_ps(oneMinusTwice(yy, zz), sx), _mm_mul_ps(twiceSum(xy, wz), sx),
+                       _mm_mul_ps(twiceDiff(xz, wy), sx), zero, out + i, 0);
+        StoreColumnSSE(_mm_mul_ps(twiceDiff(xy, wz), sy), _mm_mul_ps(oneMinusTwice(xx, zz), sy),
+                       _mm_mul_ps(twiceSum(yz, wx), sy), zero, out + i, 1);
+        StoreColumnSSE(_mm_mul_ps(twiceSum(xz, wy), sz), _mm_mul_ps(twiceDiff(yz, wx), sz),
+                       _mm_mul_ps(oneMinusTwice(xx, yy), sz), zero, out + i, 2);
+        StoreColumnSSE(_mm_set_ps(t[3].x, t[2].x, t[1].x, t[0].x), _mm_set_ps(t[3].y, t[2].y, t[1].y, t[0].y),
+                       _mm_set_ps(t[3].z, t[2].z, t[1].z, t[0].z), one, out + i, 3);
+    }
+    ComposeTRSScalarBatch(translations + i, rotations + i, scales + i, out + i, count - i);
+}
+
+void PropagateHierarchySSE(const glm::mat4* locals, const uint32_t* parents, glm::mat4* worlds, size_t begin,
+                           size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+        if (parents[i] == BatchMath::rootParent) {
+            worlds[i] = locals[i];
+        } else {
+            MultiplySSE(Floats(worlds[parents[i]]), Floats(locals[i]), Floats(worlds[i]));
+        }
+    }
+}
+
+// a.yzx * b.zxy - a.zxy * b.yzx, w stays 0
+inline __m128 CrossSSE(__m128 a, __m128 b) {
+    const __m128 aYZX = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1));
+    const __m128 bYZX = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1));
+    const __m128 c = _mm_sub_ps(_mm_mul_ps(a, bYZX), _mm_mul_ps(aYZX, b));
+    return _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 0, 2, 1));
+}
+
+inline __m128 XYZMask() { return _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1)); }
+
+void InverseTransposeSSE(const glm::mat4* matrices, glm::mat3x4* out, size_t count) {
+    const __m128 mask = XYZMask();
+    for (size_t i = 0; i < count; ++i) {
+        const float* m = Floats(matrices[i]);
+        const __m128 c0 = _mm_and_ps(_mm_loadu_ps(m), mask);
+        const __m128 c1 = _mm_and_ps(_mm_loadu_ps(m + 4), mask);
+        const __m128 c2 = _mm_and_ps(_mm_loadu_ps(m + 8), mask);
+        const __m128 r0 = CrossSSE(c1, c2), r1 = CrossSSE(c2, c0), r2 = CrossSSE(c0, c1);
+
+        const __m128 products = _mm_mul_ps(c0, r0);
+        const float det = _mm_cvtss_f32(products) + _mm_cvtss_f32(_mm_shuffle_ps(products, products, 1)) +
+                          _mm_cvtss_f32(_mm_shuffle_ps(products, products, 2));
+        const __m128 invDet = _mm_set1_ps(det != 0.0f ? 1.0f / det : 1.0f);
+
+        // masked again, a negative determinant would leave -0 in w
+        float* o = glm::value_ptr(out[i][0]);
+        _mm_storeu_ps(o, _mm_and_ps(_mm_mul_ps(r0, invDet), mask));
+        _mm_storeu_ps(o + 4, _mm_and_ps(_mm_mul_ps(r1, invDet), mask));
+        _mm_storeu_ps(o + 8, _mm_and_ps(_mm_mul_ps(r2, invDet), mask));
+    }
+}
+
+void TransformAABBsSSE(const glm::mat4* matrices, const glm::vec4* centers, const glm::vec4* extents,
+                       glm::vec4* outCenters, glm::vec4* outExtents, size_t count) {
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    for (size_t i = 0; i < count; ++i) {
+        const float* m = Floats(matrices[i]);
+        const __m128 m0 = _mm_loadu_ps(m), m1 = _mm_loadu_ps(m + 4), m2 = _mm_loadu_ps(m + 8);
+        const glm::vec4& c = centers[i];
+        const glm::vec4& e = extents[i];
+
+        __m128 center = _mm_mul_ps(m0, _mm_set1_ps(c.x));
+        center = _mm_add_ps(center, _mm_mul_ps(m1, _mm_set1_ps(c.y)));
+        center = _mm_add_ps(center, _mm_mul_ps(m2, _mm_set1_ps(c.z)));
+        center = _mm_add_ps(center, _mm_loadu_ps(m + 12));
+
+        __m128 extent = _mm_mul_ps(_mm_and_ps(m0, absMask), _mm_set1_ps(e.x));
+        extent = _mm_add_ps(extent, _mm_mul_ps(_mm_and_ps(m1, absMask), _mm_set1_ps(e.y)));
+        extent = _mm_add_ps(extent, _mm_mul_ps(_mm_and_ps(m2, absMask), _mm_set1_ps(e.z)));
+
+        _mm_storeu_ps(glm::value_ptr(outCenters[i]), center);
+        _mm_storeu_ps(glm::value_ptr(outExtents[i]), extent);
+    }
+}
+
+constexpr Kernels sseKernels{ComposeTRSSSE, PropagateHierarchySSE, InverseTransposeSSE, TransformAABBsSSE};
+
+////////////////////////////////////////////////////
+/// AVX2, two matrices or two columns per register, eight entries per lane for trs
+////////////////////////////////////////////////////
+// two columns of the result at once, the lhs columns are duplicated into both halves
+XRLIB_TARGET_AVX2 inline void MultiplyAVX2(const float* a, const float* b, float* out) {
+    const __m256 a0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a));
+    const __m256 a1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 4));
+    const __m256 a2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 8));
+    const __m256 a3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 12));
+    for (int j = 0; j < 4; j += 2) {
+        const __m256 bj = _mm256_loadu_ps(b + 4 * j);
+        __m256 r = _mm256_mul_ps(a0, _mm256_permute_ps(bj, 0x00));
+        r = _mm256_add_ps(r, _mm256_mul_ps(a1, _mm256_permute_ps(bj, 0x55)));
+        r = _mm256_add_ps(r, _mm256_mul_ps(a2, _mm256_permute_ps(bj, 0xAA)));
+        r = _mm256_add_ps(r, _mm256_mul_ps(a3, _mm256_permute_ps(bj, 0xFF)));
+        _mm256_storeu_ps(out + 4 * j, r);
+    }
+}
+
+XRLIB_TARGET_AVX2 inline void StoreColumnAVX2(__m256 x, __m256 y, __m256 z, __m256 w, glm::mat4* out, int column) {
+    StoreColumnSSE(_mm256_castps256_ps128(x), _mm256_castps256_ps128(y), _mm256_castps256_ps128(z),
+                   _mm256_castps256_ps128(w), out, column);
+    StoreColumnSSE(_mm256_extractf128_ps(x, 1), _mm256_extractf128_ps(y, 1), _mm256_extractf128_ps(z, 1),
+                   _mm256_extractf128_ps(w, 1), out + 4, column);
+}
+
+#define XRLIB_LANES8(v, c) \
+    _mm256_set_ps(v[7].c, v[6].c, v[5].c, v[4].c, v[3].c, v[2].c, v[1].c, v[0].c)
+
+XRLIB_TARGET_AVX2 void ComposeTRSAVX2(const glm::vec3* translations, const glm::quat* rotations,
+                                      const glm::vec3* scales, glm::mat4* out, size_t count) {
+    const __m256 one = _mm256_set1_ps(1.0f), two = _mm256_set1_ps(2.0f), zero = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const glm::quat* q = rotations + i;
+        const glm::vec3* t = translations + i;
+        const glm::vec3* s = scales + i;
+        const __m256 qx = XRLIB_LANES8(q, x), qy = XRLIB_LANES8(q, y), qz = XRLIB_LANES8(q, z);
+        const __m256 qw = XRLIB_LANES8(q, w);
+        const __m256 sx = XRLIB_LANES8(s, x), sy = XRLIB_LANES8(s, y), sz = XRLIB_LANES8(s, z);
+
+        const __m256 xx = _mm256_mul_ps(qx, qx), yy = _mm256_mul_ps(qy, qy), zz = _mm256_mul_ps(qz, qz);
+        const __m256 xy = _mm256_mul_ps(qx, qy), xz = _mm256_mul_ps(qx, qz), yz = _mm256_mul_ps(qy, qz);
+        const __m256 wx = _mm256_mul_ps(qw, qx), wy = _mm256_mul_ps(qw, qy), wz = _mm256_mul_ps(qw, qz);
+
+        const __m256 c0x = _mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(yy, zz)));
+        const __m256 c0y = _mm256_mul_ps(two, _mm256_add_ps(xy, wz));
+        const __m256 c0z = _mm256_mul_ps(two, _mm256_sub_ps(xz, wy));
+        const __m256 c1x = _mm256_mul_ps(two, _mm256_sub_ps(xy, wz));
+        const __m256 c1y = _mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(xx, zz)));
+        const __m256 c1z = _mm256_mul_ps(two, _mm256_add_ps(yz, wx));
+        const __m256 c2x = _mm256_mul_ps(two, _mm256_add_ps(xz, wy));
+        const __m256 c2y = _mm256_mul_ps(two, _mm256_sub_ps(yz, wx));
+        const __m256 c2z = _mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(xx, yy)));
+
+        StoreColumnAVX2(_mm256_mul_ps(c0x, sx), _mm256_mul_ps(c0y, sx), _mm256_mul_ps(c0z, sx), zero, out + i, 0);
+        StoreColumnAVX2(_mm256_mul_ps(c1x, sy), _mm256_mul_ps(c1y, sy), _mm256_mul_ps(c1z, sy), zero, out + i, 1);
+        StoreColumnAVX2(_mm256_mul_ps(c2x, sz), _mm256_mul_ps(c2y, sz), _mm256_mul_ps(c2z, sz), zero, out + i, 2);
+        StoreColumnAVX2(XRLIB_LANES8(t, x), XRLIB_LANES8(t, y), XRLIB_LANES8(t, z), one, out + i, 3);
+    }
+    ComposeTRSScalarBatch(translations + i, rotations + i, scales + i, out + i, count - i);
+}
+
+#undef XRLIB_LANES8
+
+XRLIB_TARGET_AVX2 void PropagateHierarchyAVX2(const glm::mat4* locals, const uint32_t* parents, glm::mat4* worlds,
+                                              size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+        if (parents[i] == BatchMath::rootParent) {
+            worlds[i] = locals[i];
+        } else {
+            MultiplyAVX2(Floats(worlds[parents[i]]), Floats(locals[i]), Floats(worlds[i]));
+        }
+    }
+}
+
+XRLIB_TARGET_AVX2 inline __m256 Load2AVX2(const float* first, const float* second) {
+    return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(first)), _mm_loadu_ps(second), 1);
+}
+
+XRLIB_TARGET_AVX2 inline __m256 CrossAVX2(__m256 a, __m256 b) {
+    const __m256 aYZX = _mm256_permute_ps(a, _MM_SHUFFLE(3, 0, 2, 1));
+    const __m256 bYZX = _mm256_permute_ps(b, _MM_SHUFFLE(3, 0, 2, 1));
+    const __m256 c = _mm256_sub_ps(_mm256_mul_ps(a, bYZX), _mm256_mul_ps(aYZX, b));
+    return _mm256_permute_ps(c, _MM_SHUFFLE(3, 0, 2, 1));
+}
+
+// two matrices per iteration, one in each half
+XRLIB_TARGET_AVX2 void InverseTransposeAVX2(const glm::mat4* matrices, glm::mat3x4* out, size_t count) {
+    const __m256 mask = _mm256_castsi256_ps(_mm256_set_epi32(0, -1, -1, -1, 0, -1, -1, -1));
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        const float* m = Floats(matrices[i]);
+        const float* n = Floats(matrices[i + 1]);
+        const __m256 c0 = _mm256_and_ps(Load2AVX2(m, n), mask);
+        const __m256 c1 = _mm256_and_ps(Load2AVX2(m + 4, n + 4), mask);
+        const __m256 c2 = _mm256_and_ps(Load2AVX2(m + 8, n + 8), mask);
+        const __m256 r0 = CrossAVX2(c1, c2), r1 = CrossAVX2(c2, c0), r2 = CrossAVX2(c0, c1);
+
+        // same summation order as the scalar and sse paths
+        alignas(32) float products[8];
+        _mm256_store_ps(products, _mm256_mul_ps(c0, r0));
+        const float det0 = products[0] + products[1] + products[2];
+        const float det1 = products[4] + products[5] + products[6];
+        const float inv0 = det0 != 0.0f ? 1.0f / det0 : 1.0f;
+        const float inv1 = det1 != 0.0f ? 1.0f / det1 : 1.0f;
+        const __m256 invDet = _mm256_set_ps(inv1, inv1, inv1, inv1, inv0, inv0, inv0, inv0);
+
+        const __m256 o0 = _mm256_and_ps(_mm256_mul_ps(r0, invDet), mask);
+        const __m256 o1 = _mm256_and_ps(_mm256_mul_ps(r1, invDet), mask);
+        const __m256 o2 = _mm256_and_ps(_mm256_mul_ps(r2, invDet), mask);
+        float* a = glm::value_ptr(out[i][0]);
+        float* b = glm::value_ptr(out[i + 1][0]);
+        _mm_storeu_ps(a, _mm256_castps256_ps128(o0));
+        _mm_storeu_ps(a + 4, _mm256_castps256_ps128(o1));
+        _mm_storeu_ps(a + 8, _mm256_castps256_ps128(o2));
+        _mm_storeu_ps(b, _mm256_extractf128_ps(o0, 1));
+        _mm_storeu_ps(b + 4, _mm256_extractf128_ps(o1, 1));
+        _mm_storeu_ps(b + 8, _mm256_extractf128_ps(o2, 1));
+    }
+    InverseTransposeSSE(matrices + i, out + i, count - i);
+}
+
+XRLIB_TARGET_AVX2 void TransformAABBsAVX2(const glm::mat4* matrices, const glm::vec4* centers,
+                                          const glm::vec4* extents, glm::vec4* outCenters, glm::vec4* outExtents,
+                                          size_t count) {
+    const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        const float* m = Floats(matrices[i]);
+        const float* n = Floats(matrices[i + 1]);
+        const __m256 m0 = Load2AVX2(m, n), m1 = Load2AVX2(m + 4, n + 4), m2 = Load2AVX2(m + 8, n + 8);
+        const __m256 c = Load2AVX2(glm::value_ptr(centers[i]), glm::value_ptr(centers[i + 1]));
+        const __m256 e = Load2AVX2(glm::value_ptr(extents[i]), glm::value_ptr(extents[i + 1]));
+
+        __m256 center = _mm256_mul_ps(m0, _mm256_permute_ps(c, 0x00));
+        center = _mm256_add_ps(center, _mm256_mul_ps(m1, _mm256_permute_ps(c, 0x55)));
+        center = _mm256_add_ps(center, _mm256_mul_ps(m2, _mm256_permute_ps(c, 0xAA)));
+        center = _mm256_add_ps(center, Load2AVX2(m + 12, n + 12));
+
+        __m256 extent = _mm256_mul_ps(_mm256_and_ps(m0, absMask), _mm256_permute_ps(e, 0x00));
+        extent = _mm256_add_ps(extent, _mm256_mul_ps(_mm256_and_ps(m1, absMask), _mm256_permute_ps(e, 0x55)));
+        extent = _mm256_add_ps(extent, _mm256_mul_ps(_mm256_and_ps(m2, absMask), _mm256_permute_ps(e, 0xAA)));
+
+        _mm_storeu_ps(glm::value_ptr(outCenters[i]), _mm256_castps256_ps128(center));
+        _mm_storeu_ps(glm::value_ptr(outCenters[i + 1]), _mm256_extractf128_ps(center, 1));
+        _mm_storeu_ps(glm::value_ptr(outExtents[i]), _mm256_castps256_ps128(extent));
+        _mm_storeu_ps(glm::value_ptr(outExtents[i + 1]), _mm256_extractf128_ps(extent, 1));
+    }
+    TransformAABBsSSE(matrices + i, centers + i, extents + i, outCenters + i, outExtents + i, count - i);
+}
+
+constexpr Kernels avx2Kernels{ComposeTRSAVX2, PropagateHierarchyAVX2, InverseTransposeAVX2, TransformAABBsAVX2};
+
+bool CpuSupportsAVX2() {
+    #if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    __cpuid(info, 1);
+    const bool osSavesYmm = (info[2] & (1 << 27)) && (_xgetbv(0) & 0x6) == 0x6;
+    __cpuidex(info, 7, 0);
+    return osSavesYmm && (info[1] & (1 << 5));
+    #else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+    #endif
+}
+#endif
+
+BatchMath::Implementation DetectImplementation() {
+#ifdef XRLIB_BATCHMATH_X64
+    // sse2 is part of x86-64
+    return CpuSupportsAVX2() ? BatchMath::Implementation::AVX2 : BatchMath::Implementation::SSE;
+#else
+    return BatchMath::Implementation::SCALAR;
+#endif
+}
+
+const Kernels& KernelsFor(BatchMath::Implementation implementation) {
+    switch (implementation) {
+#ifdef XRLIB_BATCHMATH_X64
+        case BatchMath::Implementation::AVX2:
+            return avx2Kernels;
+        case BatchMath::Implementation::SSE:
+            return sseKernels;
+#endif
+        default:
+            return scalarKernels;
+    }
+}
+
+std::atomic<BatchMath::Implementation>& CurrentImplementation() {
+    static std::atomic<BatchMath::Implementation> implementation{DetectImplementation()};
+    return implementation;
+}
+
+const Kernels& Active() {
+    return KernelsFor(CurrentImplementation().load(std::memory_order_relaxed));
+}
+}    // namespace
+
+void BatchMath::ComposeTRS(const glm::vec3* translations, const glm::quat* rotations, const glm::vec3* scales,
+                           glm::mat4* out, size_t count) {
+    Active().composeTRS(translations, rotations, scales, out, count);
+}
+
+void BatchMath::PropagateHierarchy(const glm::mat4* locals, const uint32_t* parents, glm::mat4* worlds,
+                                   size_t begin, size_t end) {
+    Active().propagateHierarchy(locals, parents, worlds, begin, end);
+}
+
+void BatchMath::InverseTranspose(const glm::mat4* matrices, glm::mat3x4* out, size_t count) {
+    Active().inverseTranspose(matrices, out, count);
+}
+
+void BatchMath::TransformAABBs(const glm::mat4* matrices, const glm::vec4* centers, const glm::vec4* extents,
+                               glm::vec4* outCenters, glm::vec4* outExtents, size_t count) {
+    Active().transformAABBs(matrices, centers, extents, outCenters, outExtents, count);
+}
+
+BatchMath::Implementation BatchMath::ActiveImplementation() {
+    return CurrentImplementation().load(std::memory_order_relaxed);
+}
+
+bool BatchMath::IsSupported(Implementation implementation) {
+    switch (implementation) {
+#ifdef XRLIB_BATCHMATH_X64
+        case Implementation::AVX2:
+            return CpuSupportsAVX2();
+        case Implementation::SSE:
+            return true;
+#endif
+        case Implementation::SCALAR:
+            return true;
+        default:
+            return false;
+    }
+}
+
+void BatchMath::SetImplementation(Implementation implementation) {
+    if (!IsSupported(implementation)) {
+        LOGGER(LOGGER::WARNING) << "Batch math implementation is not supported by this cpu, keeping the current one";
+        return;
+    }
+    CurrentImplementation().store(implementation, std::memory_order_relaxed);
+}
+}    // namespace XRLib
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <pch.h>
+
+namespace XRLib {
+// Math over arrays of transforms. Every kernel has a scalar, an SSE and an AVX2 implementation, the widest one the
+// cpu supports is picked on first use. Implementations use the same operation order and no fma, so they agree
+// with each other bit for bit, bench/BatchMathBenchmark.cpp checks it.
+// Outputs may alias inputs of the same index, but no other entries.
+class BatchMath {
+   public:
+    inline constexpr static uint32_t rootParent = UINT32_MAX;
+
+    enum class Implementation {
+        SCALAR,
+        SSE,
+        AVX2,
+    };
+
+    // translate * rotate * scale for every entry
+    static void ComposeTRS(const glm::vec3* translations, const glm::quat* rotations, const glm::vec3* scales,
+                           glm::mat4* out, size_t count);
+
+    // worlds[i] = worlds[parents[i]] * locals[i] for i in [begin, end), in order, so parents have to come before
+    // their children. Entries whose parent is rootParent copy their local matrix
+    static void PropagateHierarchy(const glm::mat4* locals, const uint32_t* parents, glm::mat4* worlds, size_t begin,
+                                   size_t end);
+
+    // inverse transpose of the upper 3x3, as three vec4 columns with w = 0. Singular matrices get the cofactor
+    // matrix, which points normals the same way
+    static void InverseTranspose(const glm::mat4* matrices, glm::mat3x4* out, size_t count);
+
+    // boxes given as center and half extent (w ignored), transformed to the axis aligned box around the result
+    static void TransformAABBs(const glm::mat4* matrices, const glm::vec4* centers, const glm::vec4* extents,
+                               glm::vec4* outCenters, glm::vec4* outExtents, size_t count);
+
+    static Implementation ActiveImplementation();
+    static bool IsSupported(Implementation implementation);
+    // routes every kernel to the given implementation instead of the widest one, for benchmarking and comparing
+    // implementations. Unsupported implementations are ignored
+    static void SetImplementation(Implementation implementation);
+};
+}    // namespace XRLib
@@ -22,5 +22,8 @@ class Config {
     // input
     float mouseSensitivity = 0.1f;
     float movementSpeed = 5.0f;
+
+    // xr frames are simulated on the calling thread and rendered on a separate thread
+    bool pipelinedFrames = false;
 };
 }    // namespace XRLib
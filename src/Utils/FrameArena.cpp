@@ -0,0 +1,46 @@
+#include "FrameArena.h"
+
+namespace XRLib {
+FrameArena& FrameArena::ThreadLocal() {
+    thread_local FrameArena arena;
+    return arena;
+}
+
+void FrameArena::Reset() {
+    if (blocks.size() > 1) {
+        size_t totalSize = 0;
+        for (const auto& block : blocks) {
+            totalSize += block.size;
+        }
+        blocks.clear();
+        blocks.push_back({std::unique_ptr<std::byte[]>(new std::byte[totalSize]), totalSize});
+    }
+    currentBlock = 0;
+    offset = 0;
+}
+
+void* FrameArena::do_allocate(size_t bytes, size_t alignment) {
+    while (true) {
+        if (currentBlock < blocks.size()) {
+            auto& block = blocks[currentBlock];
+            void* pointer = block.memory.get() + offset;
+            size_t space = block.size - offset;
+            if (std::align(alignment, bytes, pointer, space) != nullptr) {
+                offset = static_cast<std::byte*>(pointer) - block.memory.get() + bytes;
+                return pointer;
+            }
+            // blocks after the current one are left over from before a scope rewound, they are reused first
+            if (currentBlock + 1 < blocks.size()) {
+                ++currentBlock;
+                offset = 0;
+                continue;
+            }
+        }
+
+        const size_t size = std::max(blocks.empty() ? initialBlockSize : blocks.back().size * 2, bytes + alignment);
+        blocks.push_back({std::unique_ptr<std::byte[]>(new std::byte[size]), size});
+        currentBlock = blocks.size() - 1;
+        offset = 0;
+    }
+}
+}    // namespace XRLib
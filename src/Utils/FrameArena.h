@@ -0,0 +1,52 @@
+#pragma once
+
+#include <pch.h>
+
+#include <memory_resource>
+
+namespace XRLib {
+// Linear allocator for temporaries that don't outlive the frame, one per thread. Allocating bumps an offset and
+// deallocating does nothing. Reset rewinds the arena at the start of every frame and merges the blocks added on
+// overflow into one, so steady frames never reach the heap.
+// Scope rewinds to where the arena was when the scope started, for short lived buffers on threads without frames.
+// Everything allocated inside a scope dies with it, even if it was meant to last the frame
+class FrameArena : public std::pmr::memory_resource {
+   public:
+    inline constexpr static size_t initialBlockSize = 64 * 1024;
+
+    class Scope {
+       public:
+        Scope() : arena{ThreadLocal()}, block{arena.currentBlock}, offset{arena.offset} {}
+        ~Scope() {
+            arena.currentBlock = block;
+            arena.offset = offset;
+        }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+       private:
+        FrameArena& arena;
+        size_t block;
+        size_t offset;
+    };
+
+    static FrameArena& ThreadLocal();
+
+    // everything allocated from the arena is invalid afterwards, call it only between frames
+    void Reset();
+
+   private:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* pointer, size_t bytes, size_t alignment) override {}
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+   private:
+    struct Block {
+        std::unique_ptr<std::byte[]> memory;
+        size_t size;
+    };
+    std::vector<Block> blocks;
+    size_t currentBlock{0};
+    size_t offset{0};
+};
+}    // namespace XRLib
@@ -0,0 +1,55 @@
+#include "FramePipeline.h"
+#include "FrameArena.h"
+
+namespace XRLib {
+FramePipeline::FramePipeline() : renderThread{&FramePipeline::RenderLoop, this} {}
+
+FramePipeline::~FramePipeline() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+    }
+    condition.notify_all();
+    renderThread.join();
+}
+
+void FramePipeline::Submit(std::function<void()> render, const std::function<void()>& handOff) {
+    std::unique_lock<std::mutex> lock(mutex);
+    condition.wait(lock, [this]() { return !busy; });
+    if (handOff) {
+        handOff();
+    }
+    pendingFrame = std::move(render);
+    busy = true;
+    condition.notify_all();
+}
+
+void FramePipeline::WaitIdle() {
+    std::unique_lock<std::mutex> lock(mutex);
+    condition.wait(lock, [this]() { return !busy; });
+}
+
+void FramePipeline::RenderLoop() {
+    while (true) {
+        std::function<void()> frame;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [this]() { return stop || busy; });
+            if (!busy) {
+                return;
+            }
+            frame = std::move(pendingFrame);
+            pendingFrame = nullptr;
+        }
+
+        FrameArena::ThreadLocal().Reset();
+        frame();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            busy = false;
+        }
+        condition.notify_all();
+    }
+}
+}    // namespace XRLib
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <pch.h>
+
+namespace XRLib {
+// Hands frames from the simulation thread to a dedicated render thread. One frame is rendered while the next one is
+// simulated, Submit blocks until the render thread has finished the previous frame.
+class FramePipeline {
+   public:
+    FramePipeline();
+    ~FramePipeline();
+
+    // waits for the render thread, runs handOff on the calling thread while both threads are in sync and then
+    // renders the frame on the render thread. Data double buffered between the threads is swapped in handOff
+    void Submit(std::function<void()> render, const std::function<void()>& handOff = {});
+    // blocks until the submitted frame is finished, must not be called from the render thread
+    void WaitIdle();
+
+   private:
+    void RenderLoop();
+
+   private:
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::function<void()> pendingFrame;
+    bool busy{false};
+    bool stop{false};
+    std::thread renderThread;
+};
+}    // namespace XRLib
@@ -0,0 +1,16 @@
+#include "NameTable.h"
+
+namespace XRLib {
+const std::string& NameTable::Intern(std::string_view name) {
+    // node based, so elements never move when the set grows
+    static std::unordered_set<std::string, Hash, std::equal_to<>> names;
+    static std::mutex mutex;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = names.find(name);
+    if (it == names.end()) {
+        it = names.emplace(name).first;
+    }
+    return *it;
+}
+}    // namespace XRLib
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <pch.h>
+
+#include <unordered_set>
+
+namespace XRLib {
+// Every distinct entity name is stored once, entities only keep a pointer to it. Imported files repeat the same
+// node and mesh names many times, and most entities keep the default name. Names are never released, references
+// stay valid for the lifetime of the program
+class NameTable {
+   public:
+    static const std::string& Intern(std::string_view name);
+
+   private:
+    struct Hash {
+        using is_transparent = void;
+        size_t operator()(std::string_view name) const { return std::hash<std::string_view>{}(name); }
+    };
+};
+}    // namespace XRLib
@@ -168,6 +168,81 @@ std::size_t Util::HashString(const std::string& content) {
     return hashFunction(content);
 }
 
+std::array<uint64_t, 2> Util::Hash128(std::string_view content, uint64_t seed) {
+    auto rotl = [](uint64_t x, int r) { return (x << r) | (x >> (64 - r)); };
+    auto fmix = [](uint64_t k) {
+        k ^= k >> 33;
+        k *= 0xff51afd7ed558ccdULL;
+        k ^= k >> 33;
+        k *= 0xc4ceb9fe1a85ec53ULL;
+        k ^= k >> 33;
+        return k;
+    };
+    // little endian reads regardless of host order, so hashes match across platforms
+    auto load = [&content](size_t offset, size_t count) {
+        uint64_t value = 0;
+        for (size_t i = 0; i < count; ++i) {
+            value |= static_cast<uint64_t>(static_cast<uint8_t>(content[offset + i])) << (8 * i);
+        }
+        return value;
+    };
+
+    constexpr uint64_t c1 = 0x87c37b91114253d5ULL;
+    constexpr uint64_t c2 = 0x4cf5ad432745937fULL;
+    const size_t length = content.size();
+    const size_t blocks = length / 16;
+    uint64_t h1 = seed;
+    uint64_t h2 = seed;
+
+    for (size_t i = 0; i < blocks; ++i) {
+        uint64_t k1 = load(i * 16, 8);
+        uint64_t k2 = load(i * 16 + 8, 8);
+
+        k1 *= c1;
+        k1 = rotl(k1, 31);
+        k1 *= c2;
+        h1 ^= k1;
+        h1 = rotl(h1, 27);
+        h1 += h2;
+        h1 = h1 * 5 + 0x52dce729;
+
+        k2 *= c2;
+        k2 = rotl(k2, 33);
+        k2 *= c1;
+        h2 ^= k2;
+        h2 = rotl(h2, 31);
+        h2 += h1;
+        h2 = h2 * 5 + 0x38495ab5;
+    }
+
+    const size_t tail = blocks * 16;
+    const size_t remaining = length & 15;
+    if (remaining > 8) {
+        uint64_t k2 = load(tail + 8, remaining - 8);
+        k2 *= c2;
+        k2 = rotl(k2, 33);
+        k2 *= c1;
+        h2 ^= k2;
+    }
+    if (remaining > 0) {
+        uint64_t k1 = load(tail, std::min<size_t>(remaining, 8));
+        k1 *= c1;
+        k1 = rotl(k1, 31);
+        k1 *= c2;
+        h1 ^= k1;
+    }
+
+    h1 ^= length;
+    h2 ^= length;
+    h1 += h2;
+    h2 += h1;
+    h1 = fmix(h1);
+    h2 = fmix(h2);
+    h1 += h2;
+    h2 += h1;
+    return {h1, h2};
+}
+
 std::filesystem::path Util::ResolvePath(const std::filesystem::path& path) {
     std::filesystem::path res = path;
     if (!path.empty() && path.native()[0] == '~') {
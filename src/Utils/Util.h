@@ -18,6 +18,8 @@ class Util {
     static std::vector<uint32_t> ReadBinaryFile(const std::filesystem::path& filePath);
     static bool WriteFile(const std::filesystem::path& filePath, const std::vector<uint32_t>& data);
     static std::size_t HashString(const std::string& content);
+    // stable across compilers and runs (MurmurHash3 x64 128), use it for anything persisted to disk
+    static std::array<uint64_t, 2> Hash128(std::string_view content, uint64_t seed = 0);
     static std::filesystem::path ResolvePath(const std::filesystem::path& path);
     static std::string GetFileNameWithoutExtension(const std::filesystem::path& filePath);
 
@@ -0,0 +1,63 @@
+#include "WorkerPool.h"
+
+namespace XRLib {
+WorkerPool::WorkerPool(size_t threadCount) {
+    threads.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; ++i) {
+        threads.emplace_back(&WorkerPool::WorkerLoop, this);
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+    }
+    wake.notify_all();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+void WorkerPool::Run(size_t count, const std::function<void(size_t)>& task) {
+    if (count == 0) {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    job = &task;
+    taskCount = count;
+    nextTask = 0;
+    finishedTasks = 0;
+    wake.notify_all();
+
+    RunTasks(lock);
+    // task outlives the job only until every claimed task returned
+    finished.wait(lock, [this]() { return finishedTasks == taskCount; });
+    job = nullptr;
+}
+
+void WorkerPool::WorkerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait(lock, [this]() { return stop || (job != nullptr && nextTask < taskCount); });
+        if (stop) {
+            return;
+        }
+        RunTasks(lock);
+    }
+}
+
+void WorkerPool::RunTasks(std::unique_lock<std::mutex>& lock) {
+    while (job != nullptr && nextTask < taskCount) {
+        const size_t task = nextTask++;
+        const auto& fn = *job;
+        lock.unlock();
+        fn(task);
+        lock.lock();
+        if (++finishedTasks == taskCount) {
+            finished.notify_all();
+        }
+    }
+}
+}    // namespace XRLib
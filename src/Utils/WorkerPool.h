@@ -0,0 +1,35 @@
+#pragma once
+
+#include <pch.h>
+
+namespace XRLib {
+// Persistent threads for fork join work inside a frame, so per frame jobs do not pay for starting threads. Run hands
+// the task indices of one job to the workers and the calling thread, and returns once every task has finished.
+// Only one thread may call Run at a time.
+class WorkerPool {
+   public:
+    explicit WorkerPool(size_t threadCount);
+    ~WorkerPool();
+
+    // runs task(0) ... task(count - 1), every index exactly once on some thread
+    void Run(size_t count, const std::function<void(size_t)>& task);
+
+    size_t ThreadCount() const { return threads.size(); }
+
+   private:
+    void WorkerLoop();
+    // claims and runs tasks of the current job until none are left, expects the lock to be held
+    void RunTasks(std::unique_lock<std::mutex>& lock);
+
+   private:
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable finished;
+    const std::function<void(size_t)>* job{nullptr};
+    size_t taskCount{0};
+    size_t nextTask{0};
+    size_t finishedTasks{0};
+    bool stop{false};
+    std::vector<std::thread> threads;
+};
+}    // namespace XRLib
@@ -1,4 +1,5 @@
 #include "XrBackend.h"
+#include "Utils/FrameArena.h"
 
 namespace XRLib {
 namespace XR {
@@ -59,6 +60,11 @@ void XrBackend::Prepare() {
     CreateXrSwapchain();
     PrepareXrSwapchainImages();
     input = std::move(XrInput(xrCore));
+
+    EventSystem::Callback<> lateLatchCallback = [this]() {
+        LateLatchPoses();
+    };
+    EventSystem::RegisterListener(Events::XRLIB_EVENT_RENDERER_PRE_QUEUE_SUBMIT, lateLatchCallback);
 }
 
 void XrBackend::CreateXrInstance() {
@@ -311,6 +317,15 @@ void XrBackend::PrepareXrSwapchainImages() {
 
 XrResult XrBackend::StartFrame(uint32_t& imageIndex) {
     frameStarted = false;
+    XrFrameState frameState{XR_TYPE_FRAME_STATE};
+    XrResult result;
+    if ((result = WaitFrame(frameState)) != XR_SUCCESS) {
+        return result;
+    }
+    return BeginFrame(frameState, imageIndex);
+}
+
+XrResult XrBackend::WaitFrame(XrFrameState& frameState) {
     PollEvents();
     if (!this->sessionRunning)
         return XR_ERROR_RUNTIME_FAILURE;
@@ -328,7 +343,17 @@ XrResult XrBackend::StartFrame(uint32_t& imageIndex) {
         LOGGER(LOGGER::ERR) << "Failed to wait frame";
         return result;
     }
+    frameState = xrCore.GetXrFrameState();
+
+    input.UpdateInput();
+    return XR_SUCCESS;
+}
 
+XrResult XrBackend::BeginFrame(const XrFrameState& frameState, uint32_t& imageIndex) {
+    frameStarted = false;
+    renderFrameState = frameState;
+
+    XrResult result;
     XrFrameBeginInfo frameBeginInfo{XR_TYPE_FRAME_BEGIN_INFO};
     if ((result = xrBeginFrame(xrCore.GetXRSession(), &frameBeginInfo)) != XR_SUCCESS) {
         LOGGER(LOGGER::ERR) << "Failed to begin frame";
@@ -336,7 +361,7 @@ XrResult XrBackend::StartFrame(uint32_t& imageIndex) {
     }
     frameStarted = true;
 
-    if (!xrCore.GetXrFrameState().shouldRender)
+    if (!renderFrameState.shouldRender)
         return XR_ERROR_RUNTIME_FAILURE;
 
     UpdateViews();
@@ -354,8 +379,6 @@ XrResult XrBackend::StartFrame(uint32_t& imageIndex) {
         return result;
     }
 
-    input.UpdateInput();
-
     return XR_SUCCESS;
 }
 
@@ -372,13 +395,13 @@ XrResult XrBackend::EndFrame(uint32_t& imageIndex) {
     compositionLayerProjection.viewCount = xrCore.GetXRViewConfigurationView().size();
     compositionLayerProjection.views = xrCore.GetCompositionLayerProjectionViews().data();
 
-    std::vector<XrCompositionLayerBaseHeader*> layers;
-    if (xrCore.GetXrFrameState().shouldRender) {
+    std::pmr::vector<XrCompositionLayerBaseHeader*> layers{&FrameArena::ThreadLocal()};
+    if (renderFrameState.shouldRender) {
         layers.push_back(reinterpret_cast<XrCompositionLayerBaseHeader*>(&compositionLayerProjection));
     }
 
     XrFrameEndInfo frameEndInfo{XR_TYPE_FRAME_END_INFO};
-    frameEndInfo.displayTime = xrCore.GetXrFrameState().predictedDisplayTime;
+    frameEndInfo.displayTime = renderFrameState.predictedDisplayTime;
     frameEndInfo.layerCount = layers.size();
     frameEndInfo.layers = layers.data();
     frameEndInfo.environmentBlendMode = XR_ENVIRONMENT_BLEND_MODE_OPAQUE;
@@ -433,6 +456,11 @@ void XrBackend::PollEvents() {
                     LOGGER(LOGGER::WARNING) << "XrEventDatasessionStateChanged for unknow session";
                     break;
                 }
+                if ((sessionStateChanged->state == XR_SESSION_STATE_READY ||
+                     sessionStateChanged->state == XR_SESSION_STATE_STOPPING) &&
+                    renderIdleWait) {
+                    renderIdleWait();
+                }
                 if (sessionStateChanged->state == XR_SESSION_STATE_READY) {
                     BeginSession();
                 }
@@ -455,12 +483,25 @@ void XrBackend::PollEvents() {
     }
 }
 
+void XrBackend::LateLatchPoses() {
+    if (!frameStarted || !renderFrameState.shouldRender)
+        return;
+
+    // composition layer poses are updated together with the view matrices, so the compositor reprojects from
+    // exactly the poses the frame is rendered with
+    UpdateViews();
+    // controller poses move scene entities, which belong to the simulation thread once frames are pipelined
+    if (!config.pipelinedFrames) {
+        input.UpdatePosePosition(renderFrameState.predictedDisplayTime);
+    }
+}
+
 void XrBackend::UpdateViews() {
     XrResult result;
     xrCore.GetXrViewState().type = XR_TYPE_VIEW_STATE;
     XrViewLocateInfo viewLocateInfo{XR_TYPE_VIEW_LOCATE_INFO};
     viewLocateInfo.viewConfigurationType = xrCore.GetXrViewConfigurationType();
-    viewLocateInfo.displayTime = xrCore.GetXrFrameState().predictedDisplayTime;
+    viewLocateInfo.displayTime = renderFrameState.predictedDisplayTime;
     viewLocateInfo.space = xrCore.GetXrSpace();
     if ((result = xrLocateViews(xrCore.GetXRSession(), &viewLocateInfo, &xrCore.GetXrViewState(),
                                 xrCore.GetXrViews().size(), &viewCount, xrCore.GetXrViews().data())) != XR_SUCCESS) {
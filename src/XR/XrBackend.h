@@ -12,9 +12,17 @@ class XrBackend {
     XrBackend(Config& config, Graphics::VkCore& core, XrCore& xrCore);
     ~XrBackend();
 
+    // single threaded frame start, WaitFrame followed by BeginFrame
     XrResult StartFrame(uint32_t& imageIndex);
+    // simulation side of a frame: polls events, waits for the frame timing and updates input
+    XrResult WaitFrame(XrFrameState& frameState);
+    // render side of a frame: begins it, locates the views and acquires the swapchain image
+    XrResult BeginFrame(const XrFrameState& frameState, uint32_t& imageIndex);
     XrResult EndFrame(uint32_t& imageIndex);
 
+    // called before the session begins or ends, so a pipelined render thread can finish its frame first
+    void SetRenderIdleWait(std::function<void()> wait) { renderIdleWait = std::move(wait); }
+
     bool XrShouldStop() { return xrShouldStop; };
 
    private:
@@ -31,6 +39,9 @@ class XrBackend {
     void EndSession();
 
     void UpdateViews();
+    // relocates views and controllers for the same display time just before queue submit, the runtime's
+    // prediction is shorter and more accurate by then
+    void LateLatchPoses();
     void PollEvents();
 
    private:
@@ -50,6 +61,9 @@ class XrBackend {
     XrDebugUtilsMessengerEXT xrDebugUtilsMessenger{XR_NULL_HANDLE};
 
     uint32_t viewCount;
+    // timing of the frame being rendered, xrCore's frame state may already belong to the next simulated frame
+    XrFrameState renderFrameState{XR_TYPE_FRAME_STATE};
+    std::function<void()> renderIdleWait;
     bool sessionRunning{false};
     bool frameStarted{false};
     bool xrShouldStop{false};
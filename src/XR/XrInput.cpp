@@ -102,24 +102,22 @@ void XrInput::UpdateInput() {
 
     xrSyncActions(core->GetXRSession(), &syncInfo);
 
-    UpdatePosePosition();
+    UpdatePosePosition(core->GetXrFrameState().predictedDisplayTime);
     UpdateTriggerValue();
     UpdateGripValue();
 }
 
-void XrInput::UpdatePosePosition() {
+void XrInput::UpdatePosePosition(XrTime displayTime) {
     XrSpaceLocation spaceLocation{XR_TYPE_SPACE_LOCATION};
 
-    if (xrLocateSpace(leftHandSpace, core->GetXrSpace(), core->GetXrFrameState().predictedDisplayTime,
-                      &spaceLocation) == XR_SUCCESS) {
+    if (xrLocateSpace(leftHandSpace, core->GetXrSpace(), displayTime, &spaceLocation) == XR_SUCCESS) {
         if (spaceLocation.locationFlags & XR_SPACE_LOCATION_POSITION_VALID_BIT) {
             EventSystem::TriggerEvent<Transform>(Events::XRLIB_EVENT_LEFT_CONTROLLER_POSITION,
                                       Transform{MathUtil::XrPoseToMatrix(spaceLocation.pose)});
         }
     }
 
-    if (xrLocateSpace(rightHandSpace, core->GetXrSpace(), core->GetXrFrameState().predictedDisplayTime,
-                      &spaceLocation) == XR_SUCCESS) {
+    if (xrLocateSpace(rightHandSpace, core->GetXrSpace(), displayTime, &spaceLocation) == XR_SUCCESS) {
         if (spaceLocation.locationFlags & XR_SPACE_LOCATION_POSITION_VALID_BIT) {
             EventSystem::TriggerEvent<Transform>(Events::XRLIB_EVENT_RIGHT_CONTROLLER_POSITION,
                                       Transform{MathUtil::XrPoseToMatrix(spaceLocation.pose)});
@@ -13,10 +13,11 @@ class XrInput {
     XrInput() = default;
     ~XrInput() = default;
     void UpdateInput();
+    // locates the hand spaces at the given time and triggers the controller position events
+    void UpdatePosePosition(XrTime displayTime);
 
    private:
     void CreateDefaultInteractionActionBindings();
-    void UpdatePosePosition();
     void UpdateTriggerValue();
     void UpdateGripValue();
 
@@ -15,6 +15,7 @@ XRLib::XRLib() {
 }
 
 XRLib::~XRLib() {
+    framePipeline.reset();
     Graphics::WindowHandler::Deinitialize();
 }
 
@@ -35,6 +36,11 @@ XRLib& XRLib::EnableValidationLayer() {
     return *this;
 }
 
+XRLib& XRLib::EnablePipelinedFrames() {
+    info.pipelinedFrames = true;
+    return *this;
+}
+
 XRLib& XRLib::SetCustomOpenXRRuntime(const std::filesystem::path& runtimePath) {
     auto fullPath = Util::ResolvePath(runtimePath);
     if (!std::filesystem::is_regular_file(fullPath)) {
@@ -69,6 +75,8 @@ XRLib& XRLib::Init(bool xr, std::unique_ptr<Graphics::StandardRB> renderBahavior
     initialized = true;
     LOGGER(LOGGER::INFO) << "XRLib Initialized";
 
+    // default shaders compile on workers while meshes are still importing
+    Graphics::VkStandardRB::PrecompileDefaultShaders(xrCore.IsXRValid());
     SceneBackend().WaitForAllMeshesToLoad();
 
     if (renderBahavior) {
@@ -79,22 +87,35 @@ XRLib& XRLib::Init(bool xr, std::unique_ptr<Graphics::StandardRB> renderBahavior
 
     if (!xrCore.IsXRValid()) {
         Graphics::WindowHandler::ShowWindow();
+    } else if (info.pipelinedFrames) {
+        framePipeline = std::make_unique<FramePipeline>();
+        xrBackend->SetRenderIdleWait([this]() { framePipeline->WaitIdle(); });
     }
     return *this;
 }
 
 void XRLib::Run() {
     UpdateDeltaTime();
+    // the previous frame's temporaries of this thread are dead, the render thread resets its own
+    FrameArena::ThreadLocal().Reset();
 
-    EventSystem::TriggerEvent(Events::XRLIB_EVENT_APPLICATION_PRE_RENDERING);
+    if (framePipeline) {
+        RunPipelined();
+        return;
+    }
 
+    // window input moves the flat camera, it has to land in this frame's snapshot
     if (!xrCore.IsXRValid()) {
         Graphics::WindowHandler::Update();
     }
 
+    EventSystem::TriggerEvent(Events::XRLIB_EVENT_APPLICATION_PRE_RENDERING);
+    renderBackend->ExtractSnapshot();
+
     uint32_t imageIndex = 0;
 
     auto recordFrame = [&](uint32_t index) {
+        renderBackend->SwapSnapshots();
         renderBackend->RecordFrame(index);
     };
 
@@ -111,6 +132,29 @@ void XRLib::Run() {
     EventSystem::TriggerEvent(Events::XRLIB_EVENT_APPLICATION_POST_RENDERING);
 }
 
+void XRLib::RunPipelined() {
+    // xrWaitFrame blocks until the runtime wants the next frame, meanwhile the render thread works on the last one
+    XrFrameState frameState{XR_TYPE_FRAME_STATE};
+    const bool waited = xrBackend->WaitFrame(frameState) == XR_SUCCESS;
+
+    EventSystem::TriggerEvent(Events::XRLIB_EVENT_APPLICATION_PRE_RENDERING);
+    renderBackend->ExtractSnapshot();
+
+    if (waited) {
+        auto renderFrame = [this, frameState]() {
+            uint32_t imageIndex = 0;
+            if (xrBackend->BeginFrame(frameState, imageIndex) == XR_SUCCESS) {
+                renderBackend->RecordFrame(imageIndex);
+            }
+            xrBackend->EndFrame(imageIndex);
+        };
+        // recording only reads the snapshot handed off here, so the simulation goes on with the next frame
+        framePipeline->Submit(renderFrame, [this]() { renderBackend->SwapSnapshots(); });
+    }
+
+    EventSystem::TriggerEvent(Events::XRLIB_EVENT_APPLICATION_POST_RENDERING);
+}
+
 void XRLib::UpdateDeltaTime() {
     auto currentTime = std::chrono::steady_clock::now();
 
@@ -6,6 +6,8 @@
 #include "Graphics/RenderBackendFlat.h"
 #include "Scene/Scene.h"
 #include "XR/XrBackend.h"
+#include "Utils/FrameArena.h"
+#include "Utils/FramePipeline.h"
 #include "Utils/Time.h"
 
 namespace XRLib {
@@ -16,6 +18,10 @@ class XRLib {
     XRLib& SetApplicationName(const std::string& applicationName);
     XRLib& SetVersionNumber(unsigned int majorVersion, unsigned int minorVersion, unsigned int patchVersion);
     XRLib& EnableValidationLayer();
+    // xr only: Run simulates a frame on the calling thread while the previous one is recorded and submitted on a
+    // render thread. Event listeners of the scene run on the calling thread, HEAD_MOVEMENT and renderer events on
+    // the render thread
+    XRLib& EnablePipelinedFrames();
     XRLib& SetCustomOpenXRRuntime(const std::filesystem::path& runtimePath);
     XRLib& Init(bool xr = true, std::unique_ptr<Graphics::StandardRB> renderBahavior = nullptr);
     XRLib& InitDefaultRenderPasses();
@@ -33,6 +39,7 @@ class XRLib {
 
    private:
     void UpdateDeltaTime();
+    void RunPipelined();
 
    private:
     Config info;
@@ -41,6 +48,8 @@ class XRLib {
     XR::XrCore xrCore;
     std::unique_ptr<XR::XrBackend> xrBackend{nullptr};
     std::unique_ptr<Graphics::RenderBackend> renderBackend{nullptr};
+    // declared after the backends, the render thread has to stop before they are destroyed
+    std::unique_ptr<FramePipeline> framePipeline{nullptr};
     bool initialized = false;
 
     void InitXRBackend();